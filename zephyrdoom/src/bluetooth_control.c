@@ -4,6 +4,7 @@
 #include <dk_buttons_and_leds.h>
 #include <errno.h>
 #include <stddef.h>
+#include <string.h>
 #include <zephyr/bluetooth/bluetooth.h>
 #include <zephyr/bluetooth/conn.h>
 #include <zephyr/bluetooth/gatt.h>
@@ -17,9 +18,8 @@
 #include <zephyr/sys/printk.h>
 #include <zephyr/types.h>
 
-#include "d_event.h"
-#include "doomkeys.h"
-#include "m_controls.h"
+#include "hid_report.h"
+#include "i_timer.h"
 
 #define BLINK_INTERVAL_MS 500
 #define LED1_NODE DT_ALIAS(led0)
@@ -52,201 +52,16 @@ static connected_device_t current_device_type = DEVICE_TYPE_NONE;
 
 static void hids_on_ready(struct k_work *work);
 static K_WORK_DEFINE(hids_ready_work, hids_on_ready);
+static void hids_on_map_read(struct k_work *work);
+static K_WORK_DEFINE(hids_map_work, hids_on_map_read);
 
-static void parse_xbox_report(const uint8_t *data, size_t len) {
-    static bool prev_dpad_up, prev_dpad_down, prev_button_back,
-        prev_button_start;
-    static event_t prev_joystick_event;
-
-    event_t joystick_event;
-    event_t keyboard_event;
-    joystick_event.type = ev_joystick;
-    keyboard_event.type = ev_keydown;
-
-    bool dpad_up = data[12] == 0x01;
-    bool dpad_down = data[12] == 0x05;
-    bool button_A = data[13] == 0x01;
-    bool button_B = data[13] == 0x02;
-    bool button_X = data[13] == 0x08;
-    bool button_Y = data[13] == 0x10;
-    bool button_back = data[14] == 0x04;
-    bool button_start = data[14] == 0x08;
-    joystick_event.data1 =
-        (button_A << 4) | (button_B << 5) | (button_X << 2) | (button_Y << 3);
-
-    int32_t leftJoyX = (data[1] << 8 | data[0]);
-    int32_t leftJoyY = (data[3] << 8 | data[2]);
-
-    leftJoyX = ((leftJoyX - 32767) / (double)32767) * 65;
-    leftJoyY = ((leftJoyY - 32767) / (double)32767) * 65;
-    if (leftJoyX > -8 && leftJoyX < 8) {
-        leftJoyX = 0;
-    }
-    if (leftJoyY > -8 && leftJoyY < 8) {
-        leftJoyY = 0;
-    }
-
-    joystick_event.data2 = leftJoyX;
-    joystick_event.data3 = leftJoyY;
-
-    int16_t LT = data[8];
-    int16_t RT = data[10];
-    if (LT > 5) {
-        joystick_event.data4 = -LT;
-    } else if (RT > 5) {
-        joystick_event.data4 = RT;
-    } else {
-        joystick_event.data4 = 0;
-    }
-
-    if (joystick_event.data1 != prev_joystick_event.data1 ||
-        joystick_event.data2 != prev_joystick_event.data2 ||
-        joystick_event.data3 != prev_joystick_event.data3 ||
-        joystick_event.data4 != prev_joystick_event.data4) {
-        D_PostEvent(&joystick_event);
-        prev_joystick_event = joystick_event;
-    }
+// The report map is read when a device is ready, and reports are decoded
+// by the layout built from it.
+#define REPORT_MAP_MAX 512
 
-    if (dpad_up && !prev_dpad_up) {
-        keyboard_event.data1 = key_up;
-        D_PostEvent(&keyboard_event);
-    }
-    if (dpad_down && !prev_dpad_down) {
-        keyboard_event.data1 = key_down;
-        D_PostEvent(&keyboard_event);
-    }
-    if (button_back && !prev_button_back) {
-        keyboard_event.data1 = key_map_toggle;
-        D_PostEvent(&keyboard_event);
-    }
-    if (button_start && !prev_button_start) {
-        keyboard_event.data1 = key_menu_activate;
-        D_PostEvent(&keyboard_event);
-    }
-
-    prev_dpad_up = dpad_up;
-    prev_dpad_down = dpad_down;
-    prev_button_back = button_back;
-    prev_button_start = button_start;
-}
-
-static void parse_keyboard_report(const uint8_t *data, size_t len) {
-    typedef struct {
-        uint8_t hid;
-        int doom;
-        int ascii;
-    } keymap_t;
-    static const keymap_t key_map[] = {
-        {0x04, 'a', 'a'},         {0x05, 'b', 'b'},
-        {0x06, 'c', 'c'},         {0x07, 'd', 'd'},
-        {0x08, 'e', 'e'},         {0x09, 'f', 'f'},
-        {0x0A, 'g', 'g'},         {0x0B, 'h', 'h'},
-        {0x0C, 'i', 'i'},         {0x0D, 'j', 'j'},
-        {0x0E, 'k', 'k'},         {0x0F, 'l', 'l'},
-        {0x10, 'm', 'm'},         {0x11, 'n', 'n'},
-        {0x12, 'o', 'o'},         {0x13, 'p', 'p'},
-        {0x14, 'q', 'q'},         {0x15, 'r', 'r'},
-        {0x16, 's', 's'},         {0x17, 't', 't'},
-        {0x18, 'u', 'u'},         {0x19, 'v', 'v'},
-        {0x1A, 'w', 'w'},         {0x1B, 'x', 'x'},
-        {0x1C, 'y', 'y'},         {0x1D, 'z', 'z'},
-        {0x1E, '1', '1'},         {0x1F, '2', '2'},
-        {0x20, '3', '3'},         {0x21, '4', '4'},
-        {0x22, '5', '5'},         {0x23, '6', '6'},
-        {0x24, '7', '7'},         {0x25, '8', '8'},
-        {0x26, '9', '9'},         {0x27, '0', '0'},
-        {0x28, KEY_ENTER, 0},     {0x29, KEY_ESCAPE, 0},
-        {0x2A, KEY_BACKSPACE, 0}, {0x2B, KEY_TAB, 0},
-        {0x2C, ' ', ' '},         {0x36, ',', ','},
-        {0x37, '.', '.'},         {0x4F, KEY_RIGHTARROW, 0},
-        {0x50, KEY_LEFTARROW, 0}, {0x51, KEY_DOWNARROW, 0},
-        {0x52, KEY_UPARROW, 0},   {0x3A, KEY_F1, 0},
-        {0x3B, KEY_F2, 0},        {0x3C, KEY_F3, 0},
-        {0x3D, KEY_F4, 0},        {0x3E, KEY_F5, 0},
-        {0x3F, KEY_F6, 0},        {0x40, KEY_F7, 0},
-        {0x41, KEY_F8, 0},        {0x42, KEY_F9, 0},
-        {0x43, KEY_F10, 0},       {0x44, KEY_F11, 0},
-        {0x45, KEY_F12, 0},
-    };
-    typedef struct {
-        uint8_t bitmask;
-        int doom;
-    } modmap_t;
-    static const modmap_t mod_map[] = {
-        {0x01, KEY_RCTRL}, {0x02, KEY_RSHIFT}, {0x04, KEY_RALT},
-        {0x10, KEY_RCTRL}, {0x20, KEY_RSHIFT}, {0x40, KEY_RALT},
-    };
-
-    static uint8_t last_modifier_byte = 0;
-    static uint8_t previously_pressed_hids[6] = {0};
-
-    if (len < 8) return;
-
-    uint8_t current_modifier_byte = data[0];
-    int mod_map_size = sizeof(mod_map) / sizeof(mod_map[0]);
-
-    for (int i = 0; i < mod_map_size; i++) {
-        uint8_t bit = mod_map[i].bitmask;
-        if ((current_modifier_byte & bit) && !(last_modifier_byte & bit)) {
-            event_t e = {.type = ev_keydown, .data1 = mod_map[i].doom};
-            D_PostEvent(&e);
-        } else if (!(current_modifier_byte & bit) &&
-                   (last_modifier_byte & bit)) {
-            event_t e = {.type = ev_keyup, .data1 = mod_map[i].doom};
-            D_PostEvent(&e);
-        }
-    }
-    last_modifier_byte = current_modifier_byte;
-
-    uint8_t current_pressed_hids[6];
-    memcpy(current_pressed_hids, &data[2], sizeof(current_pressed_hids));
-    int key_map_size = sizeof(key_map) / sizeof(key_map[0]);
-
-    for (int i = 0; i < 6; i++) {
-        uint8_t current_hid = current_pressed_hids[i];
-        if (current_hid == 0x00 || current_hid == 0x01) continue;
-        bool was_pressed_before = false;
-        for (int j = 0; j < 6; j++) {
-            if (previously_pressed_hids[j] == current_hid) {
-                was_pressed_before = true;
-                break;
-            }
-        }
-        if (!was_pressed_before) {
-            for (int k = 0; k < key_map_size; k++) {
-                if (key_map[k].hid == current_hid) {
-                    event_t e = {.type = ev_keydown,
-                                 .data1 = key_map[k].doom,
-                                 .data2 = key_map[k].ascii};
-                    D_PostEvent(&e);
-                    break;
-                }
-            }
-        }
-    }
-    for (int i = 0; i < 6; i++) {
-        uint8_t previous_hid = previously_pressed_hids[i];
-        if (previous_hid == 0x00 || previous_hid == 0x01) continue;
-        bool still_pressed = false;
-        for (int j = 0; j < 6; j++) {
-            if (current_pressed_hids[j] == previous_hid) {
-                still_pressed = true;
-                break;
-            }
-        }
-        if (!still_pressed) {
-            for (int k = 0; k < key_map_size; k++) {
-                if (key_map[k].hid == previous_hid) {
-                    event_t e = {.type = ev_keyup, .data1 = key_map[k].doom};
-                    D_PostEvent(&e);
-                    break;
-                }
-            }
-        }
-    }
-    memcpy(previously_pressed_hids, current_pressed_hids,
-           sizeof(previously_pressed_hids));
-}
+static uint8_t report_map[REPORT_MAP_MAX];
+static size_t report_map_len;
+static hid_layout_t hid_layout;
 
 struct bt_gatt_dm {
     struct bt_conn *conn;
@@ -318,20 +133,16 @@ static void convert_xbox_uuids(struct bt_gatt_dm *dm) {
 static uint8_t hogp_notify_cb(struct bt_hogp *hogp_ctx,
                               struct bt_hogp_rep_info *rep, uint8_t err,
                               const uint8_t *data) {
+    // Events from a report carry the time it arrived, so input latency is
+    // measured from here.
+    uint32_t timestamp = I_GetTimeRaw();
+
     if (err || !data) {
         return BT_GATT_ITER_STOP;
     }
 
-    switch (current_device_type) {
-        case DEVICE_TYPE_XBOX:
-            parse_xbox_report(data, bt_hogp_rep_size(rep));
-            break;
-        case DEVICE_TYPE_KEYBOARD:
-            parse_keyboard_report(data, bt_hogp_rep_size(rep));
-            break;
-        default:
-            break;
-    }
+    hid_report_decode(&hid_layout, bt_hogp_rep_id(rep), data,
+                      bt_hogp_rep_size(rep), timestamp);
 
     return BT_GATT_ITER_CONTINUE;
 }
@@ -442,8 +253,50 @@ BT_CONN_CB_DEFINE(conn_callbacks) = {
     .security_changed = security_changed,
 };
 
+// Called with each part of the report map, and once more without data
+// when it has all been read
+static void hogp_map_read_cb(struct bt_hogp *hogp_ctx, uint8_t err,
+                             const uint8_t *data, size_t size, size_t offset) {
+    if (err || !data) {
+        k_work_submit(&hids_map_work);
+        return;
+    }
+
+    if (offset < REPORT_MAP_MAX) {
+        size = MIN(size, REPORT_MAP_MAX - offset);
+        memcpy(&report_map[offset], data, size);
+        report_map_len = MAX(report_map_len, offset + size);
+    }
+}
+
 static void hids_on_ready(struct k_work *work) {
-    printk("HIDS is ready. Subscribing to reports...\n");
+    int err;
+
+    printk("HIDS is ready. Reading report map...\n");
+
+    report_map_len = 0;
+    err = bt_hogp_map_read(&hogp, hogp_map_read_cb, 0, K_NO_WAIT);
+    if (err) {
+        printk("Report map read error (%d)\n", err);
+        k_work_submit(&hids_map_work);
+    }
+}
+
+static void hids_on_map_read(struct k_work *work) {
+    if (hid_report_parse_map(report_map, report_map_len, &hid_layout)) {
+        printk("Report map: %u bytes, %u buttons, %s%s\n",
+               (unsigned)report_map_len, hid_layout.buttons.size,
+               hid_layout.axes[HID_AXIS_X].size ? "stick " : "",
+               hid_layout.keys.size ? "keyboard" : "");
+    } else if (current_device_type == DEVICE_TYPE_XBOX) {
+        printk("Report map not usable, using the Xbox layout\n");
+        hid_report_xbox_layout(&hid_layout);
+    } else {
+        printk("Report map not usable, using the boot keyboard layout\n");
+        hid_report_keyboard_layout(&hid_layout);
+    }
+
+    printk("Subscribing to reports...\n");
     struct bt_hogp_rep_info *rep = NULL;
     while (NULL != (rep = bt_hogp_rep_next(&hogp, rep))) {
         if (bt_hogp_rep_type(rep) == BT_HIDS_REPORT_TYPE_INPUT) {
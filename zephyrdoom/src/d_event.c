@@ -21,12 +21,65 @@
 
 #include <stdlib.h>
 #include "d_event.h"
+#include "i_timer.h"
 
-#define MAXEVENTS 64
+#undef PACKED_STRUCT
+#include <zephyr/sys/atomic.h>
+
+// NRFD-NOTE: Events are posted from the Bluetooth thread as well as the
+// main loop, so the queue is a bounded multi producer, single consumer
+// ring. Producers claim a slot by moving eventhead with compare and swap,
+// then publish it through the slot's sequence number. Only the main loop
+// pops events. The sequence numbers are stored less the slot index, so
+// the ring starts out empty when zeroed.
+
+#define MAXEVENTS 64  // Power of two
 
 static event_t events[MAXEVENTS];
-static int eventhead;
-static int eventtail;
+static atomic_t event_seq[MAXEVENTS];
+static atomic_t eventhead;
+static unsigned int eventtail;
+
+static atomic_t events_posted;
+static atomic_t events_dropped;
+
+//
+// D_PostEventAt
+// Post an event captured at timestamp (raw timer time)
+//
+void D_PostEventAt (event_t* ev, uint32_t timestamp)
+{
+    uint32_t pos;
+    unsigned int slot;
+    int32_t diff;
+
+    for (;;)
+    {
+        pos = atomic_get(&eventhead);
+        slot = pos & (MAXEVENTS - 1);
+        diff = (int32_t) (atomic_get(&event_seq[slot]) + slot - pos);
+
+        if (diff == 0)
+        {
+            // Free; claim it unless another producer got there first
+            if (atomic_cas(&eventhead, pos, pos + 1))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            // Full, the main loop has not caught up
+            atomic_inc(&events_dropped);
+            return;
+        }
+    }
+
+    events[slot] = *ev;
+    events[slot].timestamp = timestamp;
+    atomic_set(&event_seq[slot], pos + 1 - slot);
+    atomic_inc(&events_posted);
+}
 
 //
 // D_PostEvent
@@ -34,28 +87,37 @@ static int eventtail;
 //
 void D_PostEvent (event_t* ev)
 {
-    events[eventhead] = *ev;
-    eventhead = (eventhead + 1) % MAXEVENTS;
+    D_PostEventAt(ev, I_GetTimeRaw());
 }
 
 // Read an event from the queue.
+// The event is copied out so that its slot can be reused straight away;
+// the pointer is valid until the next call.
 
 event_t *D_PopEvent(void)
 {
-    event_t *result;
+    static event_t result;
+    unsigned int slot = eventtail & (MAXEVENTS - 1);
 
-    // No more events waiting.
+    // No more events waiting, or the next one is still being written.
 
-    if (eventtail == eventhead)
+    if ((uint32_t) (atomic_get(&event_seq[slot]) + slot - eventtail) != 1)
     {
         return NULL;
     }
 
-    result = &events[eventtail];
+    result = events[slot];
 
     // Advance to the next event in the queue.
 
-    eventtail = (eventtail + 1) % MAXEVENTS;
+    atomic_set(&event_seq[slot], eventtail + MAXEVENTS - slot);
+    eventtail++;
+
+    return &result;
+}
 
-    return result;
+void D_GetEventStats(unsigned int *posted, unsigned int *dropped)
+{
+    *posted = atomic_get(&events_posted);
+    *dropped = atomic_get(&events_dropped);
 }
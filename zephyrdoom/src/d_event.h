@@ -75,6 +75,10 @@ typedef struct __attribute__((packed))
     // Event-specific data; see the descriptions given above.
     // NRFD-NOTE: Changed from int to short
     short data1, data2, data3, data4, data5;
+
+    // Raw timer time (I_GetTimeRaw) when the input was captured. Set by
+    // D_PostEvent and D_PostEventAt.
+    uint32_t timestamp;
 } event_t;
 
 
@@ -138,9 +142,15 @@ typedef enum
 // Called by IO functions when input is detected.
 void D_PostEvent (event_t *ev);
 
+// Same, for input captured earlier, at timestamp (raw timer time)
+void D_PostEventAt (event_t *ev, uint32_t timestamp);
+
 // Read an event from the event queue
 
 event_t *D_PopEvent(void);
 
+// Events posted, and dropped because the queue was full, since startup
+void D_GetEventStats(unsigned int *posted, unsigned int *dropped);
+
 
 #endif
@@ -29,6 +29,7 @@
 
 #include "m_argv.h"
 #include "m_fixed.h"
+#include "m_latency.h"
 
 #include "net_client.h"
 #include "net_gui.h"
@@ -795,6 +796,7 @@ void TryRunTics (void)
             memcpy(local_playeringame, set->ingame, sizeof(local_playeringame));
 
             loop_interface->RunTic(set->cmds, set->ingame);
+            M_LatencyTic(gametic);
             gametic++;
 
             // modify command for duplicated tics
@@ -107,6 +107,14 @@
 #define CXMTOF(x)  (f_x + MTOF((x)-m_x))
 #define CYMTOF(y)  (f_y + (f_h - MTOF((y)-m_y)))
 
+// NRFD-NOTE: Same, with (s) bits of sub pixel precision
+#define MTOFS(x,s) (FixedMul((x),scale_mtof)>>(FRACBITS-(s)))
+#define CXMTOFS(x,s) ((f_x<<(s)) + MTOFS((x)-m_x,s))
+#define CYMTOFS(y,s) ((f_y<<(s)) + ((f_h<<(s)) - MTOFS((y)-m_y,s)))
+
+// Sub pixel bits of lines drawn by the display
+#define LINEFRACBITS 4
+
 typedef struct
 {
     int x, y;
@@ -196,6 +204,11 @@ static int      grid = 0;
 
 static int      leveljuststarted = 1;   // kluge until AM_LevelInit() is called
 
+// NRFD-NOTE: Lines are handed to the display instead of drawn into the
+// frame buffer, unless there are too many of them this frame.
+static boolean  amlines;
+static boolean  amlinesfull;
+
 boolean         automapactive = false;
 static int      finit_width = SCREENWIDTH;
 static int      finit_height = SCREENHEIGHT - ST_HEIGHT;
@@ -546,6 +559,7 @@ void AM_Stop (void)
     static event_t st_notify = { 0, ev_keyup, AM_MSGEXITED, 0 };
 
     AM_unloadPics();
+    I_StopMapLines();
     automapactive = false;
     ST_Responder(&st_notify);
     stopped = true;
@@ -873,7 +887,8 @@ void AM_clearFB(int color)
 boolean
 AM_clipMline
 ( mline_t*      ml,
-  fline_t*      fl )
+  fline_t*      fl,
+  int           shift )
 {
     enum
     {
@@ -890,14 +905,16 @@ AM_clipMline
     fpoint_t    tmp;
     int         dx;
     int         dy;
+    int         w = f_w << shift;
+    int         h = f_h << shift;
 
 
 #define DOOUTCODE(oc, mx, my) \
     (oc) = 0; \
     if ((my) < 0) (oc) |= TOP; \
-    else if ((my) >= f_h) (oc) |= BOTTOM; \
+    else if ((my) >= h) (oc) |= BOTTOM; \
     if ((mx) < 0) (oc) |= LEFT; \
-    else if ((mx) >= f_w) (oc) |= RIGHT;
+    else if ((mx) >= w) (oc) |= RIGHT;
 
 
     // do trivial rejects and outcodes
@@ -928,10 +945,10 @@ AM_clipMline
         return false; // trivially outside
 
     // transform to frame-buffer coordinates.
-    fl->a.x = CXMTOF(ml->a.x);
-    fl->a.y = CYMTOF(ml->a.y);
-    fl->b.x = CXMTOF(ml->b.x);
-    fl->b.y = CYMTOF(ml->b.y);
+    fl->a.x = CXMTOFS(ml->a.x, shift);
+    fl->a.y = CYMTOFS(ml->a.y, shift);
+    fl->b.x = CXMTOFS(ml->b.x, shift);
+    fl->b.y = CYMTOFS(ml->b.y, shift);
 
     DOOUTCODE(outcode1, fl->a.x, fl->a.y);
     DOOUTCODE(outcode2, fl->b.x, fl->b.y);
@@ -953,28 +970,28 @@ AM_clipMline
         {
             dy = fl->a.y - fl->b.y;
             dx = fl->b.x - fl->a.x;
-            tmp.x = fl->a.x + (dx*(fl->a.y))/dy;
+            tmp.x = fl->a.x + ((int64_t)dx*(fl->a.y))/dy;
             tmp.y = 0;
         }
         else if (outside & BOTTOM)
         {
             dy = fl->a.y - fl->b.y;
             dx = fl->b.x - fl->a.x;
-            tmp.x = fl->a.x + (dx*(fl->a.y-f_h))/dy;
-            tmp.y = f_h-1;
+            tmp.x = fl->a.x + ((int64_t)dx*(fl->a.y-h))/dy;
+            tmp.y = h-1;
         }
         else if (outside & RIGHT)
         {
             dy = fl->b.y - fl->a.y;
             dx = fl->b.x - fl->a.x;
-            tmp.y = fl->a.y + (dy*(f_w-1 - fl->a.x))/dx;
-            tmp.x = f_w-1;
+            tmp.y = fl->a.y + ((int64_t)dy*(w-1 - fl->a.x))/dx;
+            tmp.x = w-1;
         }
         else if (outside & LEFT)
         {
             dy = fl->b.y - fl->a.y;
             dx = fl->b.x - fl->a.x;
-            tmp.y = fl->a.y + (dy*(-fl->a.x))/dx;
+            tmp.y = fl->a.y + ((int64_t)dy*(-fl->a.x))/dx;
             tmp.x = 0;
         }
         else
@@ -1091,7 +1108,15 @@ AM_drawMline
 {
     static fline_t fl;
 
-    if (AM_clipMline(ml, &fl))
+    if (amlines)
+    {
+        if (AM_clipMline(ml, &fl, LINEFRACBITS)
+         && !I_AddMapLine(fl.a.x, fl.a.y, fl.b.x, fl.b.y, color))
+            amlinesfull = true;
+        return;
+    }
+
+    if (AM_clipMline(ml, &fl, 0))
         AM_drawFline(&fl, color); // draws it on frame buffer using fb coords
 }
 
@@ -1369,15 +1394,24 @@ void AM_drawMarks(void)
 
 void AM_drawCrosshair(int color)
 {
+    int x, y;
+
+    if (amlines)
+    {
+        // A line ending where it starts is drawn as a dot
+        x = ((f_w/2) << LINEFRACBITS) + (1 << (LINEFRACBITS-1));
+        y = ((f_h/2) << LINEFRACBITS) + (1 << (LINEFRACBITS-1));
+        if (!I_AddMapLine(x, y, x, y, color))
+            amlinesfull = true;
+        return;
+    }
+
     fb[(f_w*(f_h+1))/2] = color; // single point for now
 
 }
 
-void AM_Drawer (void)
+static void AM_drawMap(void)
 {
-    if (!automapactive) return;
-    fb = I_VideoBuffer;
-    AM_clearFB(BACKGROUND);
     if (grid)
         AM_drawGrid(GRIDCOLORS);
     AM_drawWalls();
@@ -1387,6 +1421,29 @@ void AM_Drawer (void)
     AM_drawCrosshair(XHAIRCOLORS);
 
     AM_drawMarks();
+}
+
+void AM_Drawer (void)
+{
+    if (!automapactive) return;
+    fb = I_VideoBuffer;
+
+    // NRFD-NOTE: Let the display draw the lines, at its own resolution,
+    // and skip sending the map area of the frame buffer.
+    amlines = I_StartMapLines(BACKGROUND);
+    if (amlines)
+    {
+        amlinesfull = false;
+        AM_drawMap();
+        amlines = false;
+        if (!amlinesfull)
+            return;
+
+        I_CancelMapLines();
+    }
+
+    AM_clearFB(BACKGROUND);
+    AM_drawMap();
 
     V_MarkRect(f_x, f_y, f_w, f_h);
 
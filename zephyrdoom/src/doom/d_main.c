@@ -51,6 +51,7 @@
 #include "m_argv.h"
 #include "m_config.h"
 #include "m_controls.h"
+#include "m_latency.h"
 #include "m_menu.h"
 #include "m_misc.h"
 #include "n_fs.h"
@@ -127,6 +128,7 @@ void D_ProcessEvents(void) {
     event_t* ev;
 
     while ((ev = D_PopEvent()) != NULL) {
+        M_LatencyEvent(ev->timestamp);
         if (M_Responder(ev)) continue;  // menu ate the event
         G_Responder(ev);
     }
@@ -153,10 +155,12 @@ void D_Display(void) {
     int nowtime;
     int tics;
     int wipestart;
+    int x;
     int y;
     boolean done;
     boolean wipe;
     boolean redrawsbar;
+    boolean scaledview;
 
     if (nodrawers) return;  // for comparative timing / profiling
 
@@ -177,6 +181,8 @@ void D_Display(void) {
         wipe = false;
 
     I_ClearVideoBuffer();
+    I_EnableStatusBarLayer(false);
+    scaledview = false;
 
     if (gamestate == GS_LEVEL && gametic) HU_Erase();
 
@@ -189,6 +195,13 @@ void D_Display(void) {
                 redrawsbar = true;
             if (inhelpscreensstate && !inhelpscreens)
                 redrawsbar = true;  // just put away the help screen
+            // Let the display composite the status bar by itself, unless
+            // a wipe or the menu may draw over it. A scaled view always
+            // needs it, as it is kept where the status bar would be drawn.
+            scaledview = viewscaled && !automapactive;
+            I_EnableScaledView(scaledview);
+            I_EnableStatusBarLayer((scaledview || (!wipe && !menuactive)) &&
+                                   (viewheight != SCREENHEIGHT || automapactive));
             ST_Drawer(viewheight == SCREENHEIGHT, redrawsbar);
             fullscreen = viewheight == SCREENHEIGHT;
             break;
@@ -215,6 +228,9 @@ void D_Display(void) {
 
     if (gamestate == GS_LEVEL && gametic) HU_Drawer();
 
+    // the menu may draw over all of a scaled view
+    if (scaledview && menuactive) I_FlushScaledView();
+
     // clean up border stuff
     if (gamestate != oldgamestate && gamestate != GS_LEVEL) {
         I_SetPalette(W_CacheLumpName(DEH_String("PLAYPAL"), PU_CACHE));
@@ -232,7 +248,11 @@ void D_Display(void) {
             y = 4;
         else
             y = viewwindowy + 4;
-        V_DrawPatchDirect(viewwindowx + (scaledviewwidth - 68) / 2, y,
+        if (viewscaled)
+            x = (SCREENWIDTH - 68) / 2;
+        else
+            x = viewwindowx + (scaledviewwidth - 68) / 2;
+        V_DrawPatchDirect(x, y,
                           W_CacheLumpName(DEH_String("M_PAUSE"), PU_CACHE));
     }
 
@@ -241,6 +261,7 @@ void D_Display(void) {
 
     // normal update
     if (!wipe) {
+        M_LatencyStage(LAT_RENDER);
         I_FinishUpdate();  // page flip or blit buffer
         return;
     }
@@ -303,6 +324,8 @@ void D_BindVariables(void) {
 
     M_BindIntVariable("sfx_volume", &sfxVolume);
     M_BindIntVariable("music_volume", &musicVolume);
+    M_BindIntVariable("screenblocks", &screenblocks);
+    M_BindIntVariable("detaillevel", &detailLevel);
 }
 
 //
@@ -32,6 +32,7 @@
 #include "f_finale.h"
 #include "m_argv.h"
 #include "m_controls.h"
+#include "m_latency.h"
 #include "m_misc.h"
 #include "m_menu.h"
 #include "m_random.h"
@@ -369,6 +370,8 @@ void G_BuildTiccmd (ticcmd_t* cmd, int maketic)
 
     // NRFD-TODO: mouse? (lots of stuff below)
 
+    M_LatencyTiccmd(maketic);
+
     memset(cmd, 0, sizeof(ticcmd_t));
 
     cmd->consistancy =
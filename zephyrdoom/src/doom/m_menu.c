@@ -76,8 +76,8 @@ const int                     showMessages = 1;
 
 
 // Blocky mode, has default, 0 = high, 1 = normal
-const int                     detailLevel = 0;
-const int                     screenblocks = 10;
+int                     detailLevel = 0;
+int                     screenblocks = 10;
 
 // temp for screenblocks (0-9)
 byte                     screenSize;
@@ -1154,8 +1154,6 @@ void M_ChangeSensitivity(int choice)
 
 void M_ChangeDetail(int choice)
 {
-    printf("NRFD-TODO: Detail level\n");
-    /*
     choice = 0;
     detailLevel = 1 - detailLevel;
 
@@ -1165,7 +1163,6 @@ void M_ChangeDetail(int choice)
         players[consoleplayer].message = DEH_String(DETAILHI);
     else
         players[consoleplayer].message = DEH_String(DETAILLO);
-    */
 }
 
 
@@ -1173,7 +1170,6 @@ void M_ChangeDetail(int choice)
 
 void M_SizeDisplay(int choice)
 {
-    printf("NRFD-TODO: M_SizeDisplay\n");/*
     switch(choice)
     {
       case 0:
@@ -1194,7 +1190,6 @@ void M_SizeDisplay(int choice)
 
 
     R_SetViewSize (screenblocks, detailLevel);
-    */
 }
 
 
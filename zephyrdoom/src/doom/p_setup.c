@@ -1077,6 +1077,9 @@ P_SetupLevel
     // Make sure all sounds are stopped before Z_FreeTags.
     S_Start ();
 
+    // Visplane use is reported per level
+    R_ReportPlanes ();
+
     Z_FreeTags (PU_LEVEL, PU_PURGELEVEL-1);
 
     // UNUSED W_Profile ();
@@ -46,7 +46,6 @@
 #include "n_buttons.h"
 
 // NRFD-TODO: Check values for all supported games
-#define MAX_TEXTURES 125
 #define MAX_TEXTURE_PATCHES 350
 #define MAX_FLATS 60
 
@@ -139,6 +138,10 @@ struct  __attribute__((packed)) texture_s
     // unsigned short*       columnofs;
     byte*                 composite;
 
+    // NRFD-NOTE: Kept in RAM, the wad_texture is in flash
+    short                 widthmask;
+    short                 height;
+
     // All the patches[patchcount]
     //  are drawn back to front into the cached texture.
     // byte       patchcount;
@@ -160,7 +163,7 @@ int                   lastspritelump;
 int                   numspritelumps;
 
 int                   numtextures;
-texture_t             textures[MAX_TEXTURES];
+texture_t*            textures;
 char*                 textures_names;
 texpatch_t*           texture_patches;
 // texture_t**           textures_hashtable; // NRFD-EXCLUDE hashtable
@@ -221,8 +224,7 @@ int R_TextureWidth(texture_t *tex)
 
 int R_TextureHeight(texture_t *tex)
 {
-    return SHORT(tex->wad_texture->height);
-    // return tex->height*4;
+    return tex->height;
 }
 
 //
@@ -431,13 +433,22 @@ void R_GenerateComposite_N (int num, texture_t *texture, char *patch_names)
             int colofs = columnofs[col_num]; // LONG(...)
             firstcol = (column_t *)((byte *)realpatch + colofs);
             column_t* col_ptr = firstcol;
+            int top = -1;
 
             while (col_ptr->topdelta != 0xff)
             {
                 int col_length = col_ptr->length;
                 byte* source = (byte *)col_ptr + 3;
                 int count = col_length;
-                int position = originy + col_ptr->topdelta;
+
+                // Tall patches: a topdelta not below the last one is
+                // relative to it, so posts can start past row 254
+                if (col_ptr->topdelta <= top)
+                    top += col_ptr->topdelta;
+                else
+                    top = col_ptr->topdelta;
+
+                int position = originy + top;
                 if (position < 0)
                 {
                     count += position;
@@ -565,26 +576,36 @@ R_GetCachedColumn
     // printf("NRF-TODO: R_GetColumn\n");
 
     texture_t      *texture;
-    short           height;
-    short           width;
 
     texture = &textures[tex];
-    col &= R_TextureWidthMask(tex);
-    height = R_TextureHeight(texture);
-    width = R_TextureWidth(texture);
+    col &= texture->widthmask;
 
-    if (col < 0 || col >= width) {
-        printf("Assertion failed: %d < %d < %d\n", 0, col, width);
-        I_Error("R_GetCachedColumn");
+#ifdef RANGECHECK
+    if (texture->composite == NULL) {
+        I_Error("R_GetCachedColumn: composite not generated");
     }
+#endif
 
-    if (texture->composite != NULL) {
-        return texture->composite + (col*height);
-    }
-    else {
-        I_Error("R_GetCachedColumn: composite not generated");
+    return texture->composite + col*texture->height;
+}
+
+//
+// R_GetTextureColumns
+// Resolve what R_TextureColumn needs once, for all columns of a seg.
+//
+void R_GetTextureColumns(int tex, texcolumns_t *cols)
+{
+    texture_t      *texture = &textures[tex];
+
+#ifdef RANGECHECK
+    if (texture->composite == NULL) {
+        I_Error("R_GetTextureColumns: composite not generated");
     }
-    return NULL;
+#endif
+
+    cols->composite = texture->composite;
+    cols->widthmask = texture->widthmask;
+    cols->height = texture->height;
 }
 
 byte*
@@ -743,9 +764,7 @@ void R_InitTextures (void)
 
     printf("R_InitTextures: nummappatches = %d, numtextures = %d\n", nummappatches, numtextures);
 
-    if (numtextures > MAX_TEXTURES) {
-        I_Error("Too many textures in WAD\n");
-    }
+    textures = Z_Malloc(numtextures*sizeof(*textures), PU_STATIC, 0);
 
 
     //      Really complex printing shit...
@@ -813,6 +832,12 @@ void R_InitTextures (void)
         width = SHORT(mtexture->width);
         height = SHORT(mtexture->height);
 
+        j = 1;
+        while (j*2 <= width)
+            j<<=1;
+        texture->widthmask = j-1;
+        texture->height = height;
+
         texture_columns_size += R_TextureWidth(texture);
         // if (patchcount > 1) {
             texture_storage_size += R_TextureWidth(texture)*R_TextureHeight(texture);
@@ -826,16 +851,7 @@ void R_InitTextures (void)
         texturecolumnlump[i] = Z_Malloc (texture->width*sizeof(**texturecolumnlump), PU_STATIC,0);
         texturecolumnofs[i] = Z_Malloc (texture->width*sizeof(**texturecolumnofs), PU_STATIC,0);
         */
-        /* NRFD-NOTE: Moved to R_TextureWidthMask
-        j = 1;
-        while (j*2 <= texture->width)
-            j<<=1;
-
-        texturewidthmask[i] = j-1;
-        */
-
-        // NRFD-NOTE: Moved to R_TextureHeight
-        // textureheight[i] = texture->height<<FRACBITS;
+        // NRFD-NOTE: texturewidthmask and textureheight moved to texture_t
     }
 
     printf("Texture patches count: %d\n", texture_patches_count);
@@ -1124,9 +1140,6 @@ int     R_TextureNumForName (const char* name)
         I_Error ("R_TextureNumForName: %s not found",
              name);
     }
-    if (i>256) {
-        I_Error("R_TextureNumForName: Only 256 textures supported");
-    }
     return i;
 }
 
@@ -1259,18 +1272,12 @@ void R_PrecacheLevel (void)
     */
 }
 
-// NRFD-TODO: Optimize/inline?
 fixed_t R_TextureHeightFixed(int num)
 {
-    return R_TextureHeight(&textures[num]) << FRACBITS;
+    return textures[num].height << FRACBITS;
 }
 
-// NRFD-TODO: Optimize/inline?
 int R_TextureWidthMask(int num)
 {
-    int texture_width = R_TextureWidth(&textures[num]);
-    int j = 1;
-    while (j*2 <= texture_width)
-        j<<=1;
-    return j-1;
+    return textures[num].widthmask;
 }
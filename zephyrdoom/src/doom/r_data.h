@@ -36,6 +36,21 @@ R_GetCachedColumn
 ( int       tex,
   int       col );
 
+// Texture columns, resolved once for all columns of a seg.
+typedef struct
+{
+    byte*       composite;
+    int         widthmask;
+    int         height;
+} texcolumns_t;
+
+void R_GetTextureColumns(int tex, texcolumns_t *cols);
+
+static inline byte *R_TextureColumn(const texcolumns_t *cols, int col)
+{
+    return cols->composite + (col & cols->widthmask)*cols->height;
+}
+
 // I/O, setting up the stuff.
 void R_InitData (void);
 void R_PrecacheLevel (void);
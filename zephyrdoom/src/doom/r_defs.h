@@ -155,10 +155,9 @@ typedef struct  __attribute__((packed))
 
     // Texture indices.
     // We do not maintain names here.
-    // NRFD-TODO: Support more than 256 textures
-    byte   toptexture;
-    byte   bottomtexture;
-    byte   midtexture;
+    short   toptexture;
+    short   bottomtexture;
+    short   midtexture;
 
     // Sector the SideDef is facing.
     // sector_t*   sector;
@@ -499,6 +498,9 @@ typedef struct  __attribute__((packed))
   short           minx;
   short           maxx;
 
+  // NRFD-NOTE: Next visplane in the R_FindPlane hash chain
+  byte      next;
+
   // leave pads for [minx-1]/[maxx+1]
 
   byte      pad1;
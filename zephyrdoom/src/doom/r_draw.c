@@ -63,8 +63,10 @@ int             scaledviewwidth;
 int             viewheight;
 int             viewwindowx;
 int             viewwindowy;
-// pixel_t*        ylookup[MAXHEIGHT];
-// int             columnofs[MAXWIDTH];
+boolean         viewscaled;
+// NRFD-NOTE: Row offsets rather than pointers, the frame buffer changes
+// every frame. columnofs is a single add and has no table.
+static unsigned short ylookupofs[MAXHEIGHT];
 
 // Color tables for different players,
 //  translate a limited part to another
@@ -89,6 +91,7 @@ int                     dc_yl;
 int                     dc_yh;
 fixed_t                 dc_iscale;
 fixed_t                 dc_texturemid;
+int                     dc_texheight;
 
 // first pixel in a column (possibly virtual)
 byte*                   dc_source;
@@ -96,15 +99,31 @@ byte*                   dc_source;
 // just for profiling
 int                     dccount;
 
-pixel_t *ylookup(int y)
+// NRFD-NOTE: A scaled view is drawn packed at the end of the frame
+// buffer, viewwidth pixels per row, and scaled up by the display.
+static int      viewbufferofs;
+static int      viewstride = SCREENWIDTH;
+
+static inline pixel_t *ylookup(int y)
 {
-    return I_VideoBuffer + (y+viewwindowy)*SCREENWIDTH;
+    return I_VideoBuffer + ylookupofs[y];
 }
 
-int columnofs(int x)
+#if VIEW_UPLOAD_TRANSPOSED
+// NRFD-NOTE: With the view uploaded transposed, columns are viewheight
+// pixels apart and rows next to each other, see R_InitBuffer.
+static int      viewcolstride = 1;
+
+static inline int columnofs(int x)
+{
+    return viewwindowx + x*viewcolstride;
+}
+#else
+static inline int columnofs(int x)
 {
     return viewwindowx + x;
 }
+#endif
 
 byte column_buffer[SCREENHEIGHT+3];
 
@@ -113,13 +132,17 @@ void R_DrawTransColumn (void)
 {
     int                 count;
     pixel_t*            dest;
+    int                 stride = viewstride;
     fixed_t             frac;
     fixed_t             fracstep;
+    const byte*         source = dc_source;
+    const lighttable_t* colormap = dc_colormap;
+    pixel_t             val;
 
-    count = dc_yh - dc_yl;
+    count = dc_yh - dc_yl + 1;
 
     // Zero length, column does not exceed a pixel.
-    if (count < 0)
+    if (count <= 0)
         return;
 
 #ifdef RANGECHECK
@@ -133,8 +156,6 @@ void R_DrawTransColumn (void)
 #endif
 
     // Framebuffer destination address.
-    // Use ylookup LUT to avoid multiply with ScreenWidth.
-    // Use columnofs LUT for subwindows?
     dest = ylookup(dc_yl) + columnofs(dc_x);
 
     // Determine scaling,
@@ -142,22 +163,28 @@ void R_DrawTransColumn (void)
     fracstep = dc_iscale;
     frac = dc_texturemid + (dc_yl-centery)*fracstep;
 
-    // Inner loop that does the actual texture mapping,
-    //  e.g. a DDA-lile scaling.
-    // This is as fast as it gets.
-    do
+    // Two pixels at a time, pink is the transparent color. Masked
+    //  textures are drawn once from top to bottom and don't wrap,
+    //  whatever their height.
+    for ( ; count >= 2; count -= 2)
     {
-        // Re-map color indices from wall texture column
-        //  using a lighting/special effects LUT.
-        pixel_t val = dc_source[(frac>>FRACBITS)&127];
-        if (val != 251) { // Use pink as transparent color
-            *dest = dc_colormap[val];
-        }
-
-        dest += SCREENWIDTH;
+        val = source[frac>>FRACBITS];
+        if (val != 251)
+            dest[0] = colormap[val];
         frac += fracstep;
+        val = source[frac>>FRACBITS];
+        if (val != 251)
+            dest[stride] = colormap[val];
+        frac += fracstep;
+        dest += stride*2;
+    }
 
-    } while (count--);
+    if (count)
+    {
+        val = source[frac>>FRACBITS];
+        if (val != 251)
+            *dest = colormap[val];
+    }
 }
 
 //
@@ -167,17 +194,23 @@ void R_DrawTransColumn (void)
 // Thus a special case loop for very fast rendering can
 //  be used. It has also been used with Wolfenstein 3D.
 //
+// NRFD-NOTE: Unrolled four times, the colormap and source are kept in
+// registers and the stride offsets fold into the stores.
+//
 void R_DrawColumn (void)
 {
     int                 count;
     pixel_t*            dest;
+    int                 stride = viewstride;
     fixed_t             frac;
     fixed_t             fracstep;
+    const byte*         source = dc_source;
+    const lighttable_t* colormap = dc_colormap;
 
-    count = dc_yh - dc_yl;
+    count = dc_yh - dc_yl + 1;
 
     // Zero length, column does not exceed a pixel.
-    if (count < 0)
+    if (count <= 0)
         return;
 
 #ifdef RANGECHECK
@@ -191,8 +224,6 @@ void R_DrawColumn (void)
 #endif
 
     // Framebuffer destination address.
-    // Use ylookup LUT to avoid multiply with ScreenWidth.
-    // Use columnofs LUT for subwindows?
     dest = ylookup(dc_yl) + columnofs(dc_x);
 
     // Determine scaling,
@@ -202,78 +233,152 @@ void R_DrawColumn (void)
 
     // Inner loop that does the actual texture mapping,
     //  e.g. a DDA-lile scaling.
-    // This is as fast as it gets.
-    do
+    // Re-map color indices from wall texture column
+    //  using a lighting/special effects LUT.
+    for ( ; count >= 4; count -= 4)
     {
-        // Re-map color indices from wall texture column
-        //  using a lighting/special effects LUT.
-        *dest = dc_colormap[dc_source[(frac>>FRACBITS)&127]];
-
-        dest += SCREENWIDTH;
+        dest[0] = colormap[source[(frac>>FRACBITS)&127]];
+        frac += fracstep;
+        dest[stride] = colormap[source[(frac>>FRACBITS)&127]];
         frac += fracstep;
+        dest[stride*2] = colormap[source[(frac>>FRACBITS)&127]];
+        frac += fracstep;
+        dest[stride*3] = colormap[source[(frac>>FRACBITS)&127]];
+        frac += fracstep;
+        dest += stride*4;
+    }
 
-    } while (count--);
+    while (count--)
+    {
+        *dest = colormap[source[(frac>>FRACBITS)&127]];
+        dest += stride;
+        frac += fracstep;
+    }
 }
 
-
-
-// UNUSED.
-// Loop unrolled.
-#if 0
-void R_DrawColumn (void)
+//
+// R_DrawPostColumn
+// Same as R_DrawColumn, for sprite posts. A post is drawn from its own
+//  first to last pixel and never wraps around the texture height,
+//  so the texture coordinate needs no mask.
+//
+void R_DrawPostColumn (void)
 {
     int                 count;
-    byte*               source;
-    byte*               dest;
-    byte*               colormap;
-
-    unsigned            frac;
-    unsigned            fracstep;
-    unsigned            fracstep2;
-    unsigned            fracstep3;
-    unsigned            fracstep4;
+    pixel_t*            dest;
+    int                 stride = viewstride;
+    fixed_t             frac;
+    fixed_t             fracstep;
+    const byte*         source = dc_source;
+    const lighttable_t* colormap = dc_colormap;
 
     count = dc_yh - dc_yl + 1;
 
-    source = dc_source;
-    colormap = dc_colormap;
-    dest = ylookup(dc_yl) + columnofs()c_x];
+    if (count <= 0)
+        return;
 
-    fracstep = dc_iscale<<9;
-    frac = (dc_texturemid + (dc_yl-centery)*dc_iscale)<<9;
+#ifdef RANGECHECK
+    if ((unsigned)dc_x >= SCREENWIDTH
+        || dc_yl < 0
+        || dc_yh >= SCREENHEIGHT) {
+        // NRFD-TODO: I_Error
+        printf ("R_DrawPostColumn: %i to %i at %i\n", dc_yl, dc_yh, dc_x);
+        return;
+    }
+#endif
 
-    fracstep2 = fracstep+fracstep;
-    fracstep3 = fracstep2+fracstep;
-    fracstep4 = fracstep3+fracstep;
+    dest = ylookup(dc_yl) + columnofs(dc_x);
 
-    while (count >= 8)
+    fracstep = dc_iscale;
+    frac = dc_texturemid + (dc_yl-centery)*fracstep;
+
+    for ( ; count >= 4; count -= 4)
     {
-        dest[0] = colormap[source[frac>>25]];
-        dest[SCREENWIDTH] = colormap[source[(frac+fracstep)>>25]];
-        dest[SCREENWIDTH*2] = colormap[source[(frac+fracstep2)>>25]];
-        dest[SCREENWIDTH*3] = colormap[source[(frac+fracstep3)>>25]];
+        dest[0] = colormap[source[frac>>FRACBITS]];
+        frac += fracstep;
+        dest[stride] = colormap[source[frac>>FRACBITS]];
+        frac += fracstep;
+        dest[stride*2] = colormap[source[frac>>FRACBITS]];
+        frac += fracstep;
+        dest[stride*3] = colormap[source[frac>>FRACBITS]];
+        frac += fracstep;
+        dest += stride*4;
+    }
+
+    while (count--)
+    {
+        *dest = colormap[source[frac>>FRACBITS]];
+        dest += stride;
+        frac += fracstep;
+    }
+}
+
+
+//
+// R_DrawTallColumn
+// Same as R_DrawColumn, for walls with textures that aren't 128 high.
+//  Power of two heights wrap with their own mask, other heights by
+//  subtracting the height, so there is no modulo per pixel.
+//
+void R_DrawTallColumn (void)
+{
+    int                 count;
+    pixel_t*            dest;
+    int                 stride = viewstride;
+    fixed_t             frac;
+    fixed_t             fracstep;
+    fixed_t             heightfrac;
+    int                 mask;
+    const byte*         source = dc_source;
+    const lighttable_t* colormap = dc_colormap;
 
-        frac += fracstep4;
+    count = dc_yh - dc_yl + 1;
 
-        dest[SCREENWIDTH*4] = colormap[source[frac>>25]];
-        dest[SCREENWIDTH*5] = colormap[source[(frac+fracstep)>>25]];
-        dest[SCREENWIDTH*6] = colormap[source[(frac+fracstep2)>>25]];
-        dest[SCREENWIDTH*7] = colormap[source[(frac+fracstep3)>>25]];
+    if (count <= 0)
+        return;
 
-        frac += fracstep4;
-        dest += SCREENWIDTH*8;
-        count -= 8;
+#ifdef RANGECHECK
+    if ((unsigned)dc_x >= SCREENWIDTH
+        || dc_yl < 0
+        || dc_yh >= SCREENHEIGHT) {
+        // NRFD-TODO: I_Error
+        printf ("R_DrawTallColumn: %i to %i at %i\n", dc_yl, dc_yh, dc_x);
+        return;
     }
+#endif
 
-    while (count > 0)
+    dest = ylookup(dc_yl) + columnofs(dc_x);
+
+    fracstep = dc_iscale;
+    frac = dc_texturemid + (dc_yl-centery)*fracstep;
+
+    if ((dc_texheight & (dc_texheight-1)) == 0)
     {
-        *dest = colormap[source[frac>>25]];
-        dest += SCREENWIDTH;
-        frac += fracstep;
-        count--;
+        mask = dc_texheight-1;
+        do
+        {
+            *dest = colormap[source[(frac>>FRACBITS)&mask]];
+            dest += stride;
+            frac += fracstep;
+        } while (--count);
+        return;
     }
+
+    // Bring the start and step into the texture once per column
+    heightfrac = dc_texheight<<FRACBITS;
+    frac %= heightfrac;
+    if (frac < 0)
+        frac += heightfrac;
+    fracstep %= heightfrac;
+
+    do
+    {
+        *dest = colormap[source[frac>>FRACBITS]];
+        dest += stride;
+        if ((frac += fracstep) >= heightfrac)
+            frac -= heightfrac;
+    } while (--count);
 }
-#endif
 
 
 void R_DrawColumnLow (void)
@@ -322,11 +427,63 @@ void R_DrawColumnLow (void)
 }
 
 
+void R_DrawTallColumnLow (void)
+{
+    int                 count;
+    pixel_t*            dest;
+    pixel_t*            dest2;
+    fixed_t             frac;
+    fixed_t             fracstep;
+    fixed_t             heightfrac;
+    int                 x;
+
+    count = dc_yh - dc_yl + 1;
+
+    if (count <= 0)
+        return;
+
+#ifdef RANGECHECK
+    if ((unsigned)dc_x >= SCREENWIDTH
+        || dc_yl < 0
+        || dc_yh >= SCREENHEIGHT)
+    {
+
+        I_Error ("R_DrawTallColumnLow: %i to %i at %i", dc_yl, dc_yh, dc_x);
+    }
+#endif
+    // Blocky mode, need to multiply by 2.
+    x = dc_x << 1;
+
+    dest = ylookup(dc_yl) + columnofs(x);
+    dest2 = ylookup(dc_yl) + columnofs(x+1);
+
+    fracstep = dc_iscale;
+    frac = dc_texturemid + (dc_yl-centery)*fracstep;
+
+    // Same wrapping as R_DrawTallColumn, for any height
+    heightfrac = dc_texheight<<FRACBITS;
+    frac %= heightfrac;
+    if (frac < 0)
+        frac += heightfrac;
+    fracstep %= heightfrac;
+
+    do
+    {
+        *dest2 = *dest = dc_colormap[dc_source[frac>>FRACBITS]];
+        dest += SCREENWIDTH;
+        dest2 += SCREENWIDTH;
+        if ((frac += fracstep) >= heightfrac)
+            frac -= heightfrac;
+    } while (--count);
+}
+
+
 //
 // Spectre/Invisibility.
 //
 #define FUZZTABLE               50
-#define FUZZOFF (SCREENWIDTH)
+// NRFD-NOTE: In rows, multiplied by the row stride of the view.
+#define FUZZOFF (1)
 
 
 const int     fuzzoffset[FUZZTABLE] =
@@ -342,6 +499,10 @@ const int     fuzzoffset[FUZZTABLE] =
 
 int     fuzzpos = 0;
 
+// NRFD-NOTE: fuzzoffset multiplied by the row stride of the view, set up
+// by R_InitBuffer.
+static int      fuzzofs[FUZZTABLE];
+
 
 //
 // Framebuffer postprocessing.
@@ -354,9 +515,10 @@ int     fuzzpos = 0;
 void R_DrawFuzzColumn (void)
 {
     int                 count;
+    int                 run;
     pixel_t*            dest;
-    fixed_t             frac;
-    fixed_t             fracstep;
+    int                 stride = viewstride;
+    const lighttable_t* colormap = colormaps + 6*256;
 
     // Adjust borders. Low...
     if (!dc_yl)
@@ -366,10 +528,10 @@ void R_DrawFuzzColumn (void)
     if (dc_yh == viewheight-1)
         dc_yh = viewheight - 2;
 
-    count = dc_yh - dc_yl;
+    count = dc_yh - dc_yl + 1;
 
     // Zero length.
-    if (count < 0)
+    if (count <= 0)
         return;
 
 #ifdef RANGECHECK
@@ -383,29 +545,28 @@ void R_DrawFuzzColumn (void)
 
     dest = ylookup(dc_yl) + columnofs(dc_x);
 
-    // Looks familiar.
-    fracstep = dc_iscale;
-    frac = dc_texturemid + (dc_yl-centery)*fracstep;
-
     // Looks like an attempt at dithering,
     //  using the colormap #6 (of 0-31, a bit
     //  brighter than average).
-    do
+    // The texture isn't read, only the frame buffer a row above
+    //  or below. Runs stop at the end of the offset table
+    //  instead of checking for it every pixel.
+    while (count > 0)
     {
-        // Lookup framebuffer, and retrieve
-        //  a pixel that is either one column
-        //  left or right of the current one.
-        // Add index from colormap to index.
-        *dest = colormaps[6*256+dest[fuzzoffset[fuzzpos]]];
-
-        // Clamp table lookup index.
-        if (++fuzzpos == FUZZTABLE)
-            fuzzpos = 0;
+        run = FUZZTABLE - fuzzpos;
+        if (run > count)
+            run = count;
+        count -= run;
 
-        dest += SCREENWIDTH;
+        do
+        {
+            *dest = colormap[dest[fuzzofs[fuzzpos++]]];
+            dest += stride;
+        } while (--run);
 
-        frac += fracstep;
-    } while (count--);
+        if (fuzzpos == FUZZTABLE)
+            fuzzpos = 0;
+    }
 }
 
 // low detail mode version
@@ -413,10 +574,10 @@ void R_DrawFuzzColumn (void)
 void R_DrawFuzzColumnLow (void)
 {
     int                 count;
+    int                 run;
     pixel_t*            dest;
     pixel_t*            dest2;
-    fixed_t             frac;
-    fixed_t             fracstep;
+    const lighttable_t* colormap = colormaps + 6*256;
     int x;
 
     // Adjust borders. Low...
@@ -427,10 +588,10 @@ void R_DrawFuzzColumnLow (void)
     if (dc_yh == viewheight-1)
         dc_yh = viewheight - 2;
 
-    count = dc_yh - dc_yl;
+    count = dc_yh - dc_yl + 1;
 
     // Zero length.
-    if (count < 0)
+    if (count <= 0)
         return;
 
     // low detail mode, need to multiply by 2
@@ -449,31 +610,25 @@ void R_DrawFuzzColumnLow (void)
     dest = ylookup(dc_yl) + columnofs(x);
     dest2 = ylookup(dc_yl) + columnofs(x+1);
 
-    // Looks familiar.
-    fracstep = dc_iscale;
-    frac = dc_texturemid + (dc_yl-centery)*fracstep;
-
-    // Looks like an attempt at dithering,
-    //  using the colormap #6 (of 0-31, a bit
-    //  brighter than average).
-    do
+    while (count > 0)
     {
-        // Lookup framebuffer, and retrieve
-        //  a pixel that is either one column
-        //  left or right of the current one.
-        // Add index from colormap to index.
-        *dest = colormaps[6*256+dest[fuzzoffset[fuzzpos]]];
-        *dest2 = colormaps[6*256+dest2[fuzzoffset[fuzzpos]]];
-
-        // Clamp table lookup index.
-        if (++fuzzpos == FUZZTABLE)
-            fuzzpos = 0;
+        run = FUZZTABLE - fuzzpos;
+        if (run > count)
+            run = count;
+        count -= run;
 
-        dest += SCREENWIDTH;
-        dest2 += SCREENWIDTH;
-
-        frac += fracstep;
-    } while (count--);
+        do
+        {
+            *dest = colormap[dest[fuzzofs[fuzzpos]]];
+            *dest2 = colormap[dest2[fuzzofs[fuzzpos]]];
+            fuzzpos++;
+            dest += SCREENWIDTH;
+            dest2 += SCREENWIDTH;
+        } while (--run);
+
+        if (fuzzpos == FUZZTABLE)
+            fuzzpos = 0;
+    }
 }
 
 
@@ -542,15 +697,22 @@ const byte   translationtables_const[256*3] = {
                     240, 241, 242, 243, 244, 245, 246, 247, 248, 249, 250, 251, 252, 253, 254, 255
                     };
 
+//
+// NRFD-NOTE: dc_translation is the translation and colormap combined, from
+// R_TranslationColormap, so a translated pixel costs one lookup.
+//
 void R_DrawTranslatedColumn (void)
 {
     int                 count;
     pixel_t*            dest;
+    int                 stride = viewstride;
     fixed_t             frac;
     fixed_t             fracstep;
+    const byte*         source = dc_source;
+    const byte*         translation = dc_translation;
 
-    count = dc_yh - dc_yl;
-    if (count <  0)
+    count = dc_yh - dc_yl + 1;
+    if (count <= 0)
         return;
 
 #ifdef RANGECHECK
@@ -571,25 +733,27 @@ void R_DrawTranslatedColumn (void)
     fracstep = dc_iscale;
     frac = dc_texturemid + (dc_yl-centery)*fracstep;
 
-    // Here we do an additional index re-mapping.
-    do
+    // Translation tables are used
+    //  to map certain colorramps to other ones,
+    //  used with PLAY sprites.
+    // Thus the "green" ramp of the player 0 sprite
+    //  is mapped to gray, red, black/indigo.
+    // Sprite posts don't wrap, as in R_DrawPostColumn.
+    for ( ; count >= 2; count -= 2)
     {
-        // Translation tables are used
-        //  to map certain colorramps to other ones,
-        //  used with PLAY sprites.
-        // Thus the "green" ramp of the player 0 sprite
-        //  is mapped to gray, red, black/indigo.
-        *dest = dc_colormap[dc_translation[dc_source[frac>>FRACBITS]]];
-        dest += SCREENWIDTH;
-
+        dest[0] = translation[source[frac>>FRACBITS]];
         frac += fracstep;
-    } while (count--);
+        dest[stride] = translation[source[frac>>FRACBITS]];
+        frac += fracstep;
+        dest += stride*2;
+    }
+
+    if (count)
+        *dest = translation[source[frac>>FRACBITS]];
 }
 
 void R_DrawTranslatedColumnLow (void)
 {
-    printf("NRFD-TODO: R_DrawTranslatedColumnLow\n"); /*
-
     int                 count;
     pixel_t*            dest;
     pixel_t*            dest2;
@@ -626,19 +790,63 @@ void R_DrawTranslatedColumnLow (void)
     // Here we do an additional index re-mapping.
     do
     {
-        // Translation tables are used
-        //  to map certain colorramps to other ones,
-        //  used with PLAY sprites.
-        // Thus the "green" ramp of the player 0 sprite
-        //  is mapped to gray, red, black/indigo.
-        *dest = dc_colormap[dc_translation[dc_source[frac>>FRACBITS]]];
-        *dest2 = dc_colormap[dc_translation[dc_source[frac>>FRACBITS]]];
+        *dest2 = *dest = dc_translation[dc_source[frac>>FRACBITS]];
         dest += SCREENWIDTH;
         dest2 += SCREENWIDTH;
 
         frac += fracstep;
     } while (count--);
-    */
+}
+
+
+//
+// R_TranslationColormap
+// NRFD-NOTE: Translation tables combined with the colormap they are drawn
+//  with. They are built when first drawn, into a small cache that is
+//  only allocated when translated sprites are seen.
+//
+#define TRANSLATIONMAPS         8
+
+typedef struct
+{
+    const byte*         translation;
+    const lighttable_t* colormap;
+    byte                table[256];
+} translationmap_t;
+
+static translationmap_t *translationmaps;
+static int              nexttranslationmap;
+
+byte *R_TranslationColormap (const byte *translation,
+                             const lighttable_t *colormap)
+{
+    translationmap_t*   map;
+    int                 i;
+
+    if (translationmaps == NULL)
+    {
+        translationmaps = Z_Malloc (TRANSLATIONMAPS*sizeof(*translationmaps),
+                                    PU_STATIC, 0);
+        memset (translationmaps, 0, TRANSLATIONMAPS*sizeof(*translationmaps));
+    }
+
+    for (i=0 ; i<TRANSLATIONMAPS ; i++)
+    {
+        map = &translationmaps[i];
+        if (map->translation == translation && map->colormap == colormap)
+            return map->table;
+    }
+
+    // Replace the oldest
+    map = &translationmaps[nexttranslationmap];
+    nexttranslationmap = (nexttranslationmap+1) % TRANSLATIONMAPS;
+
+    map->translation = translation;
+    map->colormap = colormap;
+    for (i=0 ; i<256 ; i++)
+        map->table[i] = colormap[translation[i]];
+
+    return map->table;
 }
 
 
@@ -718,6 +926,22 @@ byte*                   ds_source;
 // just for profiling
 int                     dscount;
 
+//
+// R_SpanPixel
+// Lookup pixel from flat texture tile at position, re-index using
+// light/colormap. Position has u and v packed as in R_DrawSpan.
+//
+static inline unsigned int R_SpanPixel(unsigned int position)
+{
+    unsigned int xtemp, ytemp;
+
+    // Calculate current texture index in u,v.
+    ytemp = (position >> 4) & 0x0fc0;
+    xtemp = (position >> 26);
+
+    return ds_colormap[ds_source[xtemp | ytemp]];
+}
+
 
 //
 // Draws the actual span.
@@ -726,8 +950,6 @@ void R_DrawSpan (void)
     unsigned int position, step;
     pixel_t *dest;
     int count;
-    int spot;
-    unsigned int xtemp, ytemp;
 
 #ifdef RANGECHECK
     if (ds_x2 < ds_x1
@@ -754,22 +976,56 @@ void R_DrawSpan (void)
     dest = ylookup(ds_y) + columnofs(ds_x1);
 
     // We do not check for zero spans here?
-    count = ds_x2 - ds_x1;
+    count = ds_x2 - ds_x1 + 1;
 
-    do
+#if VIEW_UPLOAD_TRANSPOSED
+    if (viewcolstride != 1)
     {
-        // Calculate current texture index in u,v.
-        ytemp = (position >> 4) & 0x0fc0;
-        xtemp = (position >> 26);
-        spot = xtemp | ytemp;
+        int colstride = viewcolstride;
 
-        // Lookup pixel from flat texture tile,
-        //  re-index using light/colormap.
-        *dest++ = ds_colormap[ds_source[spot]];
+        do
+        {
+            *dest = R_SpanPixel(position);
+            dest += colstride;
+            position += step;
+        } while (--count);
+        return;
+    }
+#endif
 
+    // NRFD-NOTE: Pixels are stored four at a time once dest is word
+    // aligned.
+    while (((uintptr_t) dest & 3) && count > 0)
+    {
+        *dest++ = R_SpanPixel(position);
         position += step;
+        count--;
+    }
 
-    } while (count--);
+    while (count >= 4)
+    {
+        uint32_t quad;
+
+        quad = R_SpanPixel(position);
+        position += step;
+        quad |= R_SpanPixel(position) << 8;
+        position += step;
+        quad |= R_SpanPixel(position) << 16;
+        position += step;
+        quad |= R_SpanPixel(position) << 24;
+        position += step;
+
+        *(uint32_t *) dest = quad;
+        dest += 4;
+        count -= 4;
+    }
+
+    while (count > 0)
+    {
+        *dest++ = R_SpanPixel(position);
+        position += step;
+        count--;
+    }
 }
 
 
@@ -853,10 +1109,8 @@ void R_DrawSpan (void)
 void R_DrawSpanLow (void)
 {
     unsigned int position, step;
-    unsigned int xtemp, ytemp;
     pixel_t *dest;
     int count;
-    int spot;
 
 #ifdef RANGECHECK
     if (ds_x2 < ds_x1
@@ -882,22 +1136,49 @@ void R_DrawSpanLow (void)
     ds_x2 <<= 1;
 
     dest = ylookup(ds_y) + columnofs(ds_x1);
+    count++;
 
-    do
+    // Lowres/blocky mode does it twice,
+    //  while scale is adjusted appropriately.
+    // NRFD-NOTE: Two texels, doubled, go out in one 32-bit store.
+    if ((uintptr_t) dest & 1)
     {
-        // Calculate current texture index in u,v.
-        ytemp = (position >> 4) & 0x0fc0;
-        xtemp = (position >> 26);
-        spot = xtemp | ytemp;
+        for ( ; count > 0 ; count--)
+        {
+            pixel_t pix = R_SpanPixel(position);
+            *dest++ = pix;
+            *dest++ = pix;
+            position += step;
+        }
+        return;
+    }
 
-        // Lowres/blocky mode does it twice,
-        //  while scale is adjusted appropriately.
-        *dest++ = ds_colormap[ds_source[spot]];
-        *dest++ = ds_colormap[ds_source[spot]];
+    if (((uintptr_t) dest & 2) && count > 0)
+    {
+        *(uint16_t *) dest = R_SpanPixel(position) * 0x0101;
+        position += step;
+        dest += 2;
+        count--;
+    }
+
+    while (count >= 2)
+    {
+        uint32_t pair;
 
+        pair = R_SpanPixel(position) * 0x0101;
+        position += step;
+        pair |= (R_SpanPixel(position) * 0x0101) << 16;
         position += step;
 
-    } while (count--);
+        *(uint32_t *) dest = pair;
+        dest += 4;
+        count -= 2;
+    }
+
+    if (count)
+    {
+        *(uint16_t *) dest = R_SpanPixel(position) * 0x0101;
+    }
 }
 
 //
@@ -914,27 +1195,48 @@ R_InitBuffer
 {
     int         i;
 
+    // NRFD-NOTE: A scaled view has no window on the screen,
+    // it is drawn packed and the display scales it up.
+    if (viewscaled)
+    {
+        viewwindowx = 0;
+        viewwindowy = 0;
+        viewbufferofs = SCREENWIDTH*SCREENHEIGHT - viewwidth*height;
+#if VIEW_UPLOAD_TRANSPOSED
+        viewstride = 1;
+        viewcolstride = height;
+#else
+        viewstride = viewwidth;
+#endif
+        for (i=0 ; i<height ; i++)
+            ylookupofs[i] = viewbufferofs + i*viewstride;
+        for (i=0 ; i<FUZZTABLE ; i++)
+            fuzzofs[i] = fuzzoffset[i]*viewstride;
+        return;
+    }
+
     // Handle resize,
     //  e.g. smaller view windows
     //  with border and/or status bar.
     viewwindowx = (SCREENWIDTH-width) >> 1;
 
-    // Column offset. For windows.
-    // NRFD-TODO: columnofs LUT?
-    // for (i=0 ; i<width ; i++)
-    //     columnofs[i] = viewwindowx + i;
-
     // Samw with base row offset.
     if (width == SCREENWIDTH)
         viewwindowy = 0;
     else
         viewwindowy = (SCREENHEIGHT-SBARHEIGHT-height) >> 1;
 
-    // Preclaculate all row offsets.
+    viewstride = SCREENWIDTH;
+#if VIEW_UPLOAD_TRANSPOSED
+    viewcolstride = 1;
+#endif
+    viewbufferofs = viewwindowy*SCREENWIDTH;
 
-    // NRFD-TODO?
-    // for (i=0 ; i<height ; i++)
-    //     ylookup[i] = I_VideoBuffer + (i+viewwindowy)*SCREENWIDTH;
+    // Preclaculate all row offsets.
+    for (i=0 ; i<height ; i++)
+        ylookupofs[i] = viewbufferofs + i*viewstride;
+    for (i=0 ; i<FUZZTABLE ; i++)
+        fuzzofs[i] = fuzzoffset[i]*viewstride;
 }
 
 
@@ -965,7 +1267,7 @@ void R_FillBackScreen (void)
     // If we are running full screen, there is no need to do any of this,
     // and the background buffer can be freed if it was previously in use.
 
-    if (scaledviewwidth == SCREENWIDTH)
+    if (scaledviewwidth == SCREENWIDTH || viewscaled)
     {
         if (background_buffer != NULL)
         {
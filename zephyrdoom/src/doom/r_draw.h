@@ -29,6 +29,7 @@ extern int              dc_yl;
 extern int              dc_yh;
 extern fixed_t          dc_iscale;
 extern fixed_t          dc_texturemid;
+extern int              dc_texheight;
 
 // first pixel in a column
 extern byte*            dc_source;
@@ -40,6 +41,13 @@ extern byte*            dc_source;
 void    R_DrawColumn (void);
 void    R_DrawColumnLow (void);
 
+// Sprite posts, which don't wrap around the texture.
+void    R_DrawPostColumn (void);
+
+// Walls of textures that aren't 128 high, dc_texheight high.
+void    R_DrawTallColumn (void);
+void    R_DrawTallColumnLow (void);
+
 // The Spectre/Invisibility effect.
 void    R_DrawFuzzColumn (void);
 void    R_DrawFuzzColumnLow (void);
@@ -70,8 +78,13 @@ extern fixed_t          ds_ystep;
 extern byte*            ds_source;
 
 extern byte*            translationtables;
+
+// Translation combined with the colormap, see R_TranslationColormap
 extern byte*            dc_translation;
 
+byte *R_TranslationColormap (const byte *translation,
+                             const lighttable_t *colormap);
+
 
 // Span blitting for rows, floor/ceiling.
 // No Sepctre effect needed.
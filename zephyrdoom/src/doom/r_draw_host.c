@@ -0,0 +1,322 @@
+//
+// Copyright(C) 2021 Nordic Semiconductor ASA
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Host benchmark of the column and span drawers, not part of the
+//      firmware. Draws the same synthetic columns and spans with
+//      R_DrawColumn, R_DrawTallColumn and R_DrawSpan and with the plain
+//      loops they replaced, checks that both draw the same pixels, and
+//      prints the time per pixel.
+//
+//      Build and run from this directory:
+//
+//          cc -O2 -I. -I.. -I../config r_draw_host.c r_draw.c
+//          ./a.out
+//
+//      The relative numbers are what matter. For target numbers, build
+//      the same file with the board's compiler flags and run it there.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "doomdef.h"
+#include "doomstat.h"
+#include "deh_str.h"
+#include "i_system.h"
+#include "i_video.h"
+#include "v_video.h"
+#include "w_wad.h"
+#include "z_zone.h"
+
+#include "r_local.h"
+
+#define HOST_JOBS       4096
+#define HOST_RUNS       20
+
+// Texture heights for the tall column drawer, one of each kind
+#define HOST_TALL_POW2  256
+#define HOST_TALL_OTHER 72
+
+// Stand-ins for what r_draw.c uses from the rest of the game
+pixel_t         host_screen[SCREENWIDTH*SCREENHEIGHT];
+pixel_t*        I_VideoBuffer = host_screen;
+int             centery = SCREENHEIGHT/2;
+lighttable_t*   colormaps;
+GameMode_t      gamemode = shareware;
+
+char *DEH_String(char *s) { return s; }
+void V_DrawPatch(int x, int y, patch_t *patch) {}
+void V_MarkRect(int x, int y, int width, int height) {}
+void V_UseBuffer(pixel_t *buffer) {}
+void V_RestoreBuffer(void) {}
+void *W_CacheLumpName(char *name, int tag) { return NULL; }
+void *Z_Malloc(int size, int tag, void *ptr) { return malloc(size); }
+void Z_Free(void *ptr) { free(ptr); }
+
+void I_Error(char *error, ...)
+{
+    printf("I_Error: %s\n", error);
+    exit(1);
+}
+
+typedef struct
+{
+    int         x, yl, yh;
+    fixed_t     iscale, texturemid;
+} column_job_t;
+
+typedef struct
+{
+    int         y, x1, x2;
+    fixed_t     xfrac, yfrac, xstep, ystep;
+} span_job_t;
+
+static column_job_t     columns[HOST_JOBS];
+static span_job_t       spans[HOST_JOBS];
+static long             column_pixels, span_pixels;
+
+static byte             texture[HOST_TALL_POW2];
+static byte             flat[64*64];
+static lighttable_t     colormap[256];
+static pixel_t          reference[SCREENWIDTH*SCREENHEIGHT];
+
+//
+// The loops the drawers replaced
+//
+
+static void BaseDrawColumn(void)
+{
+    int         count = dc_yh - dc_yl;
+    pixel_t*    dest;
+    fixed_t     frac, fracstep;
+
+    if (count < 0)
+        return;
+
+    dest = I_VideoBuffer + dc_yl*SCREENWIDTH + dc_x;
+    fracstep = dc_iscale;
+    frac = dc_texturemid + (dc_yl-centery)*fracstep;
+
+    do
+    {
+        *dest = dc_colormap[dc_source[(frac>>FRACBITS)&127]];
+        dest += SCREENWIDTH;
+        frac += fracstep;
+    } while (count--);
+}
+
+// A modulo per pixel, for any height
+static void BaseDrawTallColumn(void)
+{
+    int         count = dc_yh - dc_yl;
+    int         texel;
+    pixel_t*    dest;
+    fixed_t     frac, fracstep;
+
+    if (count < 0)
+        return;
+
+    dest = I_VideoBuffer + dc_yl*SCREENWIDTH + dc_x;
+    fracstep = dc_iscale;
+    frac = dc_texturemid + (dc_yl-centery)*fracstep;
+
+    do
+    {
+        texel = (frac>>FRACBITS) % dc_texheight;
+        if (texel < 0)
+            texel += dc_texheight;
+        *dest = dc_colormap[dc_source[texel]];
+        dest += SCREENWIDTH;
+        frac += fracstep;
+    } while (count--);
+}
+
+static void BaseDrawSpan(void)
+{
+    unsigned int position, step;
+    pixel_t *dest;
+    int count;
+
+    position = ((ds_xfrac << 10) & 0xffff0000)
+             | ((ds_yfrac >> 6)  & 0x0000ffff);
+    step = ((ds_xstep << 10) & 0xffff0000)
+         | ((ds_ystep >> 6)  & 0x0000ffff);
+
+    dest = I_VideoBuffer + ds_y*SCREENWIDTH + ds_x1;
+    count = ds_x2 - ds_x1;
+
+    do
+    {
+        *dest++ = ds_colormap[ds_source[((position >> 4) & 0x0fc0)
+                                        | (position >> 26)]];
+        position += step;
+    } while (count--);
+}
+
+//
+// Synthetic jobs, wall-like columns and floor-like spans
+//
+
+static void MakeJobs(void)
+{
+    int i, a, b;
+
+    for (i = 0; i < HOST_JOBS; i++)
+    {
+        column_job_t *c = &columns[i];
+        span_job_t *s = &spans[i];
+
+        a = rand() % SCREENHEIGHT;
+        b = rand() % SCREENHEIGHT;
+        c->x = rand() % SCREENWIDTH;
+        c->yl = a < b ? a : b;
+        c->yh = a < b ? b : a;
+        c->iscale = FRACUNIT/4 + rand() % (4*FRACUNIT);
+        c->texturemid = (rand() % 256 - 128) * FRACUNIT;
+        column_pixels += c->yh - c->yl + 1;
+
+        a = rand() % SCREENWIDTH;
+        b = rand() % SCREENWIDTH;
+        s->y = rand() % SCREENHEIGHT;
+        s->x1 = a < b ? a : b;
+        s->x2 = a < b ? b : a;
+        s->xfrac = rand() * 97;
+        s->yfrac = rand() * 89;
+        s->xstep = rand() % (2*FRACUNIT) - FRACUNIT;
+        s->ystep = rand() % (2*FRACUNIT) - FRACUNIT;
+        span_pixels += s->x2 - s->x1 + 1;
+    }
+}
+
+static void RunColumns(void (*func)(void))
+{
+    int i;
+
+    for (i = 0; i < HOST_JOBS; i++)
+    {
+        dc_x = columns[i].x;
+        dc_yl = columns[i].yl;
+        dc_yh = columns[i].yh;
+        dc_iscale = columns[i].iscale;
+        dc_texturemid = columns[i].texturemid;
+        func();
+    }
+}
+
+static void RunSpans(void (*func)(void))
+{
+    int i;
+
+    for (i = 0; i < HOST_JOBS; i++)
+    {
+        ds_y = spans[i].y;
+        ds_x1 = spans[i].x1;
+        ds_x2 = spans[i].x2;
+        ds_xfrac = spans[i].xfrac;
+        ds_yfrac = spans[i].yfrac;
+        ds_xstep = spans[i].xstep;
+        ds_ystep = spans[i].ystep;
+        func();
+    }
+}
+
+static double NowNS(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Best of HOST_RUNS, in ns per pixel
+static double Time(void (*run)(void (*)(void)), void (*func)(void),
+                   long pixels)
+{
+    double best = 0;
+    double start, time;
+    int i;
+
+    for (i = 0; i < HOST_RUNS; i++)
+    {
+        start = NowNS();
+        run(func);
+        time = (NowNS() - start) / pixels;
+
+        if (i == 0 || time < best)
+            best = time;
+    }
+
+    return best;
+}
+
+static void Compare(const char *name,
+                    void (*run)(void (*)(void)), long pixels,
+                    void (*func)(void), void (*base)(void))
+{
+    boolean same;
+
+    memset(host_screen, 0, sizeof(host_screen));
+    run(base);
+    memcpy(reference, host_screen, sizeof(reference));
+    memset(host_screen, 0, sizeof(host_screen));
+    run(func);
+    same = memcmp(reference, host_screen, sizeof(reference)) == 0;
+
+    printf("%-22s %6.2f ns/pixel, baseline %6.2f%s\n", name,
+           Time(run, func, pixels), Time(run, base, pixels),
+           same ? "" : "  PIXELS DIFFER");
+}
+
+int main(void)
+{
+    int i;
+
+    for (i = 0; i < 256; i++)
+    {
+        texture[i] = rand();
+        colormap[i] = rand();
+    }
+    for (i = 0; i < 64*64; i++)
+    {
+        flat[i] = rand();
+    }
+
+    viewwidth = SCREENWIDTH;
+    viewheight = SCREENHEIGHT;
+    R_InitBuffer(SCREENWIDTH, SCREENHEIGHT);
+    MakeJobs();
+
+    dc_source = texture;
+    dc_colormap = colormap;
+    ds_source = flat;
+    ds_colormap = colormap;
+
+    Compare("R_DrawColumn", RunColumns, column_pixels,
+            R_DrawColumn, BaseDrawColumn);
+
+    dc_texheight = HOST_TALL_POW2;
+    Compare("R_DrawTallColumn 256", RunColumns, column_pixels,
+            R_DrawTallColumn, BaseDrawTallColumn);
+
+    dc_texheight = HOST_TALL_OTHER;
+    Compare("R_DrawTallColumn 72", RunColumns, column_pixels,
+            R_DrawTallColumn, BaseDrawTallColumn);
+
+    Compare("R_DrawSpan", RunSpans, span_pixels,
+            R_DrawSpan, BaseDrawSpan);
+
+    return 0;
+}
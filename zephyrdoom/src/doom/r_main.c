@@ -28,9 +28,11 @@
 
 #include "doomdef.h"
 #include "d_loop.h"
+#include "i_video.h"
 
 #include "m_bbox.h"
 #include "m_menu.h"
+#include "z_zone.h"
 
 #include "r_local.h"
 #include "r_sky.h"
@@ -42,6 +44,10 @@
 // Fineangles in the SCREENWIDTH wide window.
 #define FIELDOFVIEW             2048
 
+// View size the const projection tables are precalculated for
+#define CONSTVIEWWIDTH          SCREENWIDTH
+#define CONSTVIEWHEIGHT         168
+
 
 
 int                     viewangleoffset;
@@ -91,7 +97,9 @@ angle_t                 clipangle;
 // flattening the arc to a flat projection plane.
 // There will be many angles mapped to the same X.
 // Was: int viewangletox
-const int                     viewangletox[FINEANGLES/2] =
+// NRFD-NOTE: The const tables are precalculated for a 320 wide view.
+const short                   *viewangletox;
+const short                   viewangletox_const[FINEANGLES/2] =
 {320, 320, 320, 320, 320, 320, 320, 320, 320, 320, 320, 320, 320, 320, 320, 320,
 320, 320, 320, 320, 320, 320, 320, 320, 320, 320, 320, 320, 320, 320, 320, 320,
 320, 320, 320, 320, 320, 320, 320, 320, 320, 320, 320, 320, 320, 320, 320, 320,
@@ -352,7 +360,8 @@ const int                     viewangletox[FINEANGLES/2] =
 // The xtoviewangle[] table maps a screen pixel
 // to the lowest viewangle that maps back to x ranges
 // from clipangle to -clipangle.
-const angle_t                 xtoviewangle[SCREENWIDTH+1] =
+const angle_t                 *xtoviewangle;
+const angle_t                 xtoviewangle_const[SCREENWIDTH+1] =
 {537395200, 534773760, 532676608, 530579456, 528482304, 526385152, 524288000, 521666560,
 519569408, 517472256, 514850816, 512753664, 510656512, 508035072, 505937920, 503316480,
 501219328, 498597888, 496500736, 493879296, 491782144, 489160704, 486539264, 484442112,
@@ -407,6 +416,8 @@ void (*colfunc) (void);
 void (*basecolfunc) (void);
 void (*fuzzcolfunc) (void);
 void (*transcolfunc) (void);
+void (*postcolfunc) (void);
+void (*tallcolfunc) (void);
 void (*spanfunc) (void);
 
 
@@ -836,6 +847,26 @@ void R_InitTables (void)
 
 
 
+//
+// Projection tables for view sizes other than the default, allocated
+// the first time such a view size is used.
+//
+static short            *viewangletox_ram;
+static angle_t          *xtoviewangle_ram;
+static fixed_t          *yslope_ram;
+static fixed_t          *distscale_ram;
+static short            *screenheightarray_ram;
+
+static void *R_ViewSizeTable(void *table, size_t size)
+{
+    if (table == NULL)
+    {
+        table = Z_Malloc(size, PU_STATIC, NULL);
+    }
+
+    return table;
+}
+
 //
 // R_InitTextureMapping
 //
@@ -844,10 +875,22 @@ void R_InitTextureMapping (void)
     int                 i;
     int                 x;
     int                 t;
-    int                 t2;
     fixed_t             focallength;
 
-    printf("NRFD-TODO: R_InitTextureMapping (review)\n");
+    // NRFD-NOTE: The const tables are only valid for the default width.
+    if (viewwidth == CONSTVIEWWIDTH)
+    {
+        viewangletox = viewangletox_const;
+        xtoviewangle = xtoviewangle_const;
+        clipangle = xtoviewangle[0];
+        return;
+    }
+
+    viewangletox_ram = R_ViewSizeTable(viewangletox_ram,
+                                       FINEANGLES/2 * sizeof(*viewangletox_ram));
+    xtoviewangle_ram = R_ViewSizeTable(xtoviewangle_ram,
+                                       (SCREENWIDTH+1) * sizeof(*xtoviewangle_ram));
+
     // Use tangent table to generate viewangletox:
     //  viewangletox will give the next greatest x
     //  after the view angle.
@@ -857,8 +900,6 @@ void R_InitTextureMapping (void)
     focallength = FixedDiv (centerxfrac,
                             finetangent[FINEANGLES/4+FIELDOFVIEW/2] );
 
-    /*
-    printf("viewangletox = {");
     for (i=0 ; i<FINEANGLES/2 ; i++)
     {
         if (finetangent[i] > FRACUNIT*2)
@@ -875,47 +916,31 @@ void R_InitTextureMapping (void)
             else if (t>viewwidth+1)
                 t = viewwidth+1;
         }
-
-        // Take out the fencepost cases from viewangletox.
-        if (t == -1)
-            t = 0;
-        else if (t == viewwidth+1)
-            t  = viewwidth;
-
-        // viewangletox[i] = t;
-        if (i != FINEANGLES/2-1)
-            printf("%d, ", t);
-        else
-            printf("%d };\n\n", t);
-        if (i % 16 == 15) printf("\n");
+        viewangletox_ram[i] = t;
     }
 
-    // NRFD-NOTE: Has to be run twice to get correct results!
-    // TODO? write viewangletox to malloc'ed buffer to get correct result in single pass?
-
     // Scan viewangletox[] to generate xtoviewangle[]:
     //  xtoviewangle will give the smallest view angle
     //  that maps to x.
-    printf("xtoviewangle = {");
     for (x=0;x<=viewwidth;x++)
     {
-        angle_t angle;
-
         i = 0;
-        while (viewangletox[i]>x)
+        while (viewangletox_ram[i]>x)
             i++;
+        xtoviewangle_ram[x] = (i<<ANGLETOFINESHIFT)-ANG90;
+    }
 
-        angle = (i<<ANGLETOFINESHIFT)-ANG90;
-        // xtoviewangle[x] = angle;
-
-        if (x != viewwidth-1)
-            printf("%d, ", angle);
-        else
-            printf("%d };\n\n", angle);
-        if (x % 8 == 7) printf("\n");
+    // Take out the fencepost cases from viewangletox.
+    for (i=0 ; i<FINEANGLES/2 ; i++)
+    {
+        if (viewangletox_ram[i] == -1)
+            viewangletox_ram[i] = 0;
+        else if (viewangletox_ram[i] == viewwidth+1)
+            viewangletox_ram[i]  = viewwidth;
     }
-    */
 
+    viewangletox = viewangletox_ram;
+    xtoviewangle = xtoviewangle_ram;
     clipangle = xtoviewangle[0];
 }
 
@@ -1012,6 +1037,18 @@ void R_ExecuteSetViewSize (void)
     detailshift = setdetail;
     viewwidth = scaledviewwidth>>detailshift;
 
+    // NRFD-NOTE: Low detail and reduced views are rendered at their own
+    // resolution and scaled up to the full view by the display, which
+    // saves both drawing and SPI time.
+    // Only the scaled view can be uploaded transposed, so with that
+    // option the status bar sized view is scaled too.
+    viewscaled = false;
+    if (detailshift || setblocks < 10
+        || (VIEW_UPLOAD_TRANSPOSED && setblocks == 10))
+        viewscaled = I_SetScaledView(viewwidth, viewheight);
+    else
+        I_SetScaledView(0, 0);
+
     centery = viewheight/2;
     centerx = viewwidth/2;
     centerxfrac = centerx<<FRACBITS;
@@ -1024,11 +1061,13 @@ void R_ExecuteSetViewSize (void)
     printf("   viewwidth       = %d\n", scaledviewwidth);
     printf("   detailshift     = %d\n", detailshift);
 
-    if (!detailshift)
+    if (!detailshift || viewscaled)
     {
         colfunc = basecolfunc = R_DrawColumn;
         fuzzcolfunc = R_DrawFuzzColumn;
         transcolfunc = R_DrawTranslatedColumn;
+        postcolfunc = R_DrawPostColumn;
+        tallcolfunc = R_DrawTallColumn;
         spanfunc = R_DrawSpan;
     }
     else
@@ -1036,6 +1075,8 @@ void R_ExecuteSetViewSize (void)
         colfunc = basecolfunc = R_DrawColumnLow;
         fuzzcolfunc = R_DrawFuzzColumnLow;
         transcolfunc = R_DrawTranslatedColumnLow;
+        postcolfunc = R_DrawColumnLow;
+        tallcolfunc = R_DrawTallColumnLow;
         spanfunc = R_DrawSpanLow;
     }
 
@@ -1048,36 +1089,53 @@ void R_ExecuteSetViewSize (void)
     pspritescale = FRACUNIT*viewwidth/SCREENWIDTH;
     pspriteiscale = FRACUNIT*SCREENWIDTH/viewwidth;
 
-    /* NRFD-TODO: view size
     // thing clipping
-    for (i=0 ; i<viewwidth ; i++)
-        screenheightarray[i] = viewheight;
-    */
+    if (viewheight == CONSTVIEWHEIGHT)
+    {
+        screenheightarray = screenheightarray_const;
+    }
+    else
+    {
+        screenheightarray_ram = R_ViewSizeTable(screenheightarray_ram,
+                                                SCREENWIDTH * sizeof(*screenheightarray_ram));
+        for (i=0 ; i<viewwidth ; i++)
+            screenheightarray_ram[i] = viewheight;
+        screenheightarray = screenheightarray_ram;
+    }
 
-    printf("NRFD-TODO: R_ExecuteSetViewSize\n");
-    /*
     // planes
-    printf("yslope = {\n");
-    for (i=0 ; i<viewheight ; i++)
+    if (viewheight == CONSTVIEWHEIGHT && scaledviewwidth == CONSTVIEWWIDTH)
     {
-        dy = ((i-viewheight/2)<<FRACBITS)+FRACUNIT/2;
-        dy = abs(dy);
-        // yslope[i] = FixedDiv ( (viewwidth<<detailshift)/2*FRACUNIT, dy);
-        fixed_t ys = FixedDiv ( (viewwidth<<detailshift)/2*FRACUNIT, dy);
-        printf("0x%X,", ys);
+        yslope = yslope_const;
+    }
+    else
+    {
+        yslope_ram = R_ViewSizeTable(yslope_ram,
+                                     SCREENHEIGHT * sizeof(*yslope_ram));
+        for (i=0 ; i<viewheight ; i++)
+        {
+            dy = ((i-viewheight/2)<<FRACBITS)+FRACUNIT/2;
+            dy = abs(dy);
+            yslope_ram[i] = FixedDiv ( (viewwidth<<detailshift)/2*FRACUNIT, dy);
+        }
+        yslope = yslope_ram;
     }
-    printf("}\n");
 
-    printf("distscale = {\n");
-    for (i=0 ; i<viewwidth ; i++)
+    if (viewwidth == CONSTVIEWWIDTH)
     {
-        cosadj = abs(finecosine[xtoviewangle[i]>>ANGLETOFINESHIFT]);
-        // distscale[i] = FixedDiv (FRACUNIT,cosadj);
-        fixed_t ds = FixedDiv (FRACUNIT,cosadj);
-        printf("0x%X,", ds);
+        distscale = distscale_const;
+    }
+    else
+    {
+        distscale_ram = R_ViewSizeTable(distscale_ram,
+                                        SCREENWIDTH * sizeof(*distscale_ram));
+        for (i=0 ; i<viewwidth ; i++)
+        {
+            cosadj = abs(finecosine[xtoviewangle[i]>>ANGLETOFINESHIFT]);
+            distscale_ram[i] = FixedDiv (FRACUNIT,cosadj);
+        }
+        distscale = distscale_ram;
     }
-    printf("}\n");
-    */
 
     // NRF-TODO: Move to const table?
 
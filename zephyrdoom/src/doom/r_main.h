@@ -35,6 +35,9 @@ extern fixed_t      viewsin;
 extern int      viewwindowx;
 extern int      viewwindowy;
 
+// View drawn at its own size, see R_InitBuffer
+extern boolean  viewscaled;
+
 
 
 extern int      centerx;
@@ -94,6 +97,8 @@ extern void     (*colfunc) (void);
 extern void     (*transcolfunc) (void);
 extern void     (*basecolfunc) (void);
 extern void     (*fuzzcolfunc) (void);
+extern void     (*postcolfunc) (void);
+extern void     (*tallcolfunc) (void);
 // No shadow effects on floors.
 extern void     (*spanfunc) (void);
 
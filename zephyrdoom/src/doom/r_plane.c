@@ -49,6 +49,26 @@ visplane_t*             lastvisplane;
 visplane_t*             floorplane;
 visplane_t*             ceilingplane;
 
+// NRFD-NOTE: Visplanes made by R_FindPlane are chained by index from a
+// hash on height, picnum and lightlevel.
+#define VISPLANEHASHSIZE 32
+#define VISPLANENONE     0xff
+static byte             visplanehash[VISPLANEHASHSIZE];
+
+#define VISPLANEHASH(height, picnum, lightlevel) \
+    ((((unsigned)(height) >> FRACBITS)*7 + (picnum)*3 + (lightlevel)) \
+     & (VISPLANEHASHSIZE-1))
+
+// Planes wanted this frame that didn't fit. They are drawn into the
+// overflow plane, which is never shown. Planes are found in BSP order,
+// front to back, so the ones left out are behind those already found,
+// but that is all: one off to the side can still be close by.
+static int              visplanes_overflow;
+static visplane_t       overflowplane;
+
+// Most visplanes a frame has wanted since R_ReportPlanes
+static int              visplanes_peak;
+
 
 // NRFD-TODO:  Find max for Doom 1 (and/or Doom 2?)
 #define MAXOPENINGS     SCREENWIDTH*16 // *64
@@ -76,8 +96,11 @@ short                   spanstop[SCREENHEIGHT];
 lighttable_t**          planezlight;
 fixed_t                 planeheight;
 
-// NRFD-TODO: CHange view size
-const fixed_t                 yslope[SCREENHEIGHT] = {
+// NRFD-NOTE: Precalculated for the default 320x168 view. Other view sizes
+// use tables in RAM set up by R_ExecuteSetViewSize.
+const fixed_t                 *yslope = yslope_const;
+const fixed_t                 *distscale = distscale_const;
+const fixed_t                 yslope_const[SCREENHEIGHT] = {
     0x1EA89,0x1F07C,0x1F693,0x1FCD1,0x20338,0x209C8,0x21084,0x2176C,0x21E84,0x225CC,0x22D47,0x234F7,0x23CDD,0x244FE,0x24D5A,0x255F4,0x25ED0,
     0x267F0,0x27157,0x27B09,0x2850A,0x28F5C,0x29A04,0x2A506,0x2B067,0x2BC2B,0x2C859,0x2D4F4,0x2E204,0x2EF8F,0x2FD9B,0x30C30,0x31B56,0x32B16,
     0x33B79,0x34C89,0x35E50,0x370DC,0x38438,0x39873,0x3AD9B,0x3C3C3,0x3DAFC,0x3F35B,0x40CF6,0x427E5,0x44444,0x46231,0x481CD,0x4A33F,0x4C6AF,
@@ -89,7 +112,7 @@ const fixed_t                 yslope[SCREENHEIGHT] = {
     0x3AD9B,0x39873,0x38438,0x370DC,0x35E50,0x34C89,0x33B79,0x32B16,0x31B56,0x30C30,0x2FD9B,0x2EF8F,0x2E204,0x2D4F4,0x2C859,
     0x2BC2B,0x2B067,0x2A506,0x29A04,0x28F5C,0x2850A,0x27B09,0x27157,0x267F0,0x25ED0,0x255F4,0x24D5A,0x244FE,0x23CDD,0x234F7,
     0x22D47,0x225CC,0x21E84,0x2176C,0x21084,0x209C8,0x20338,0x1FCD1,0x1F693,0x1F07C,0x1EA89};
-const fixed_t                 distscale[SCREENWIDTH] = {
+const fixed_t                 distscale_const[SCREENWIDTH] = {
     0x16A75,0x16912,0x167FA,0x166E4,0x165D0,0x164BF,0x163B0,0x16262,0x16158,0x16052,0x15F0B,0x15E0B,0x15D0B,0x15BCE,0x15AD6,
     0x1599F,0x158AB,0x1577C,0x1568B,0x15561,0x15475,0x15353,0x15232,0x1514E,0x15034,0x14F1B,0x14E08,0x14D2D,0x14C1D,0x14B13,
     0x14A0A,0x14902,0x14800,0x146FF,0x14601,0x14506,0x1440D,0x14319,0x14226,0x14136,0x14018,0x13F2D,0x13E46,0x13D60,0x13C50,
@@ -115,10 +138,104 @@ const fixed_t                 distscale[SCREENWIDTH] = {
 fixed_t                 basexscale;
 fixed_t                 baseyscale;
 
-// fixed_t                 cachedheight[SCREENHEIGHT];
-// fixed_t                 cacheddistance[SCREENHEIGHT];
-// fixed_t                 cachedxstep[SCREENHEIGHT];
-// fixed_t                 cachedystep[SCREENHEIGHT];
+// NRFD-NOTE: Distance and steps of each row, for the plane height last
+// drawn in it. Rows of several planes at the same height, and of the
+// same plane drawn in more than one span, are only worked out once.
+// The key is the whole planeheight, viewz has a fraction so a 16 bit
+// key would mix up nearby planes, and the steps are added up across
+// the span so they keep all 32 bits. The full screen view covers every
+// row. Costs 16 bytes a row, 3.2 KB. Off by default: r_plane_host.c
+// found no gain above the noise on the host, build with R_SPANCACHE=1
+// to try it on the board.
+#ifndef R_SPANCACHE
+#define R_SPANCACHE 0
+#endif
+
+#if R_SPANCACHE
+typedef struct
+{
+    fixed_t     height;
+    fixed_t     distance;
+    fixed_t     xstep;
+    fixed_t     ystep;
+} spanrow_t;
+
+static spanrow_t        spanrows[SCREENHEIGHT];
+#endif
+
+//
+// Flat cache
+// NRFD-NOTE: Flats live in the WAD in QSPI flash, where the random reads
+// of R_DrawSpan are slow. The flats drawn recently are copied to SRAM,
+// 4 KB each, and the least recently used one is replaced. A plane that
+// covers fewer than R_FLATCACHEAREA pixels reads less of the flat than
+// the copy would, so an uncached flat is drawn from flash for it.
+// Build with R_FLATCACHE=0 to draw straight from flash.
+//
+// Each entry is 4 KB of BSS, R_FLATCACHE*4 KB in all. Two hold the floor
+// and ceiling of most rooms, more only pay off where many flats are in
+// view and cost SRAM the zone needs.
+//
+#ifndef R_FLATCACHE
+#define R_FLATCACHE     2       // 8 KB
+#endif
+
+#ifndef R_FLATCACHEAREA
+#define R_FLATCACHEAREA 1024
+#endif
+
+#define FLATSIZE        (64*64)
+
+#if R_FLATCACHE
+static byte             flatcache[R_FLATCACHE][FLATSIZE]
+                            __attribute__((aligned(4)));
+static int              flatcachelump[R_FLATCACHE];
+static unsigned int     flatcacheused[R_FLATCACHE];
+static unsigned int     flatcacheclock;
+
+// Returns NULL when the flat isn't cached and the plane is too small
+// to be worth the copy.
+static byte *R_CacheFlat (int lumpnum, int area)
+{
+    byte*       flat;
+    int         length;
+    int         i;
+    int         oldest;
+
+    oldest = 0;
+
+    for (i=0 ; i<R_FLATCACHE ; i++)
+    {
+        if (flatcachelump[i] == lumpnum)
+        {
+            flatcacheused[i] = ++flatcacheclock;
+            return flatcache[i];
+        }
+
+        if (flatcacheused[i] < flatcacheused[oldest])
+            oldest = i;
+    }
+
+    if (area < R_FLATCACHEAREA)
+        return NULL;
+
+    flatcacheclock++;
+
+    length = W_LumpLength(lumpnum);
+    if (length > FLATSIZE)
+        length = FLATSIZE;
+
+    flat = W_CacheLumpNum(lumpnum, PU_STATIC);
+    memcpy(flatcache[oldest], flat, length);
+    W_ReleaseLumpNum(lumpnum);
+
+    flatcachelump[oldest] = lumpnum;
+    flatcacheused[oldest] = flatcacheclock;
+
+    return flatcache[oldest];
+}
+#endif
+
 
 //
 // R_InitPlanes
@@ -126,7 +243,15 @@ fixed_t                 baseyscale;
 //
 void R_InitPlanes (void)
 {
-  // Doh!
+#if R_FLATCACHE
+    int i;
+
+    for (i=0 ; i<R_FLATCACHE ; i++)
+    {
+        flatcachelump[i] = -1;
+        flatcacheused[i] = 0;
+    }
+#endif
 }
 
 
@@ -164,26 +289,27 @@ R_MapPlane
     }
 #endif
 
-    // NRFD-TODO: optimize
-    /*
-    if (planeheight != cachedheight[y])
+#if R_SPANCACHE
     {
-        cachedheight[y] = planeheight;
-        distance = cacheddistance[y] = FixedMul (planeheight, yslope[y]);
-        ds_xstep = cachedxstep[y] = FixedMul (distance,basexscale);
-        ds_ystep = cachedystep[y] = FixedMul (distance,baseyscale);
-    }
-    else
-    {
-        distance = cacheddistance[y];
-        ds_xstep = cachedxstep[y];
-        ds_ystep = cachedystep[y];
-    }
-    */
+        spanrow_t *row = &spanrows[y];
 
+        if (planeheight != row->height)
+        {
+            row->height = planeheight;
+            row->distance = FixedMul (planeheight, yslope[y]);
+            row->xstep = FixedMul (row->distance,basexscale);
+            row->ystep = FixedMul (row->distance,baseyscale);
+        }
+
+        distance = row->distance;
+        ds_xstep = row->xstep;
+        ds_ystep = row->ystep;
+    }
+#else
     distance  = FixedMul (planeheight, yslope[y]);
     ds_xstep = FixedMul (distance,basexscale);
     ds_ystep = FixedMul (distance,baseyscale);
+#endif
 
     length = FixedMul (distance,distscale[x1]);
     angle = (viewangle + xtoviewangle[x1])>>ANGLETOFINESHIFT;
@@ -228,12 +354,17 @@ void R_ClearPlanes (void)
     }
 
     lastvisplane = visplanes;
+    memset (visplanehash, VISPLANENONE, sizeof(visplanehash));
+    visplanes_overflow = 0;
 
     lastopening = openings;
 
     // texture calculation
-    // NRFD-TODO: Optimizations
-    // memset (cachedheight, 0, sizeof(cachedheight));
+#if R_SPANCACHE
+    // The steps change with the view angle, every row is stale
+    for (i=0 ; i<viewheight ; i++)
+        spanrows[i].height = 0;
+#endif
 
     // left to right mapping
     angle = (viewangle-ANG90)>>ANGLETOFINESHIFT;
@@ -246,6 +377,36 @@ void R_ClearPlanes (void)
 
 
 
+//
+// R_ReportPlanes
+//
+void R_ReportPlanes (void)
+{
+    if (visplanes_peak > 0)
+    {
+        printf ("R_ReportPlanes: %i visplanes wanted, %i available\n",
+                visplanes_peak, MAXVISPLANES);
+    }
+    visplanes_peak = 0;
+}
+
+
+//
+// R_NewPlane
+// Take a visplane from the pool, NULL when it is used up.
+//
+static visplane_t *R_NewPlane (void)
+{
+    if (lastvisplane == &visplanes[MAXVISPLANES])
+    {
+        visplanes_overflow++;
+        return NULL;
+    }
+
+    return lastvisplane++;
+}
+
+
 //
 // R_FindPlane
 //
@@ -257,6 +418,8 @@ R_FindPlane
 {
     // printf("R_FindPlane\n");
     visplane_t* check;
+    int         hash;
+    int         i;
 
     if (picnum == skyflatnum)
     {
@@ -264,24 +427,34 @@ R_FindPlane
         lightlevel = 0;
     }
 
-    for (check=visplanes; check<lastvisplane; check++)
+    hash = VISPLANEHASH(height, picnum, lightlevel);
+
+    for (i=visplanehash[hash]; i != VISPLANENONE; i=visplanes[i].next)
     {
+        check = &visplanes[i];
         if (height == check->height
             && picnum == check->picnum
             && lightlevel == check->lightlevel)
         {
-            break;
+            return check;
         }
     }
 
+    check = R_NewPlane ();
 
-    if (check < lastvisplane)
-        return check;
-
-    if (lastvisplane - visplanes == MAXVISPLANES)
-        I_Error ("R_FindPlane: no more visplanes");
-
-    lastvisplane++;
+    if (check == NULL)
+    {
+        // NRFD-NOTE: Out of visplanes. Share one with the same flat at
+        // the same height, which is only lit wrong, or else leave the
+        // plane undrawn rather than stopping the game. Which plane is
+        // left undrawn is only down to BSP order, not its distance.
+        for (check=visplanes; check<lastvisplane; check++)
+        {
+            if (height == check->height && picnum == check->picnum)
+                return check;
+        }
+        return &overflowplane;
+    }
 
     check->height = height;
     check->picnum = picnum;
@@ -289,7 +462,10 @@ R_FindPlane
     check->minx = SCREENWIDTH;
     check->maxx = -1;
 
-    memset (check->top,0xff,sizeof(check->top));
+    check->next = visplanehash[hash];
+    visplanehash[hash] = check - visplanes;
+
+    // NRFD-NOTE: top is cleared by R_CheckPlane as the plane grows
 
     return check;
 }
@@ -310,6 +486,10 @@ R_CheckPlane
     int         unionl;
     int         unionh;
     int         x;
+    visplane_t* newpl;
+
+    if (pl == &overflowplane)
+        return pl;
 
     if (start < pl->minx)
     {
@@ -339,6 +519,19 @@ R_CheckPlane
 
     if (x > intrh)
     {
+        // clear the columns the plane grows by
+        if (pl->minx > pl->maxx)
+        {
+            memset (pl->top+unionl, 0xff, unionh-unionl+1);
+        }
+        else
+        {
+            if (unionl < pl->minx)
+                memset (pl->top+unionl, 0xff, pl->minx-unionl);
+            if (unionh > pl->maxx)
+                memset (pl->top+pl->maxx+1, 0xff, unionh-pl->maxx);
+        }
+
         pl->minx = unionl;
         pl->maxx = unionh;
 
@@ -347,15 +540,20 @@ R_CheckPlane
     }
 
     // make a new visplane
-    lastvisplane->height = pl->height;
-    lastvisplane->picnum = pl->picnum;
-    lastvisplane->lightlevel = pl->lightlevel;
+    newpl = R_NewPlane ();
 
-    pl = lastvisplane++;
+    if (newpl == NULL)
+        return &overflowplane;
+
+    newpl->height = pl->height;
+    newpl->picnum = pl->picnum;
+    newpl->lightlevel = pl->lightlevel;
+
+    pl = newpl;
     pl->minx = start;
     pl->maxx = stop;
 
-    memset (pl->top,0xff,sizeof(pl->top));
+    memset (pl->top+start, 0xff, stop-start+1);
 
     return pl;
 }
@@ -409,6 +607,10 @@ void R_DrawPlanes (void)
     int                 stop;
     int                 angle;
     int                 lumpnum;
+    boolean             fromlump;
+#if R_FLATCACHE
+    int                 area;
+#endif
 
 #ifdef RANGECHECK
     if (ds_p - drawsegs > MAXDRAWSEGS)
@@ -424,6 +626,10 @@ void R_DrawPlanes (void)
                  lastopening - openings);
 #endif
 
+    // Reported once a level, to size MAXVISPLANES
+    if (lastvisplane - visplanes + visplanes_overflow > visplanes_peak)
+        visplanes_peak = lastvisplane - visplanes + visplanes_overflow;
+
     for (pl = visplanes ; pl < lastvisplane ; pl++)
     {
         if (pl->minx > pl->maxx)
@@ -460,7 +666,21 @@ void R_DrawPlanes (void)
 
         // regular flat
         lumpnum = firstflat + flattranslation[pl->picnum];
-        ds_source = W_CacheLumpNum(lumpnum, PU_STATIC);
+#if R_FLATCACHE
+        area = 0;
+        for (x=pl->minx ; x <= pl->maxx ; x++)
+        {
+            if (pl->top[x] <= pl->bottom[x])
+                area += pl->bottom[x] - pl->top[x] + 1;
+        }
+
+        ds_source = R_CacheFlat(lumpnum, area);
+        fromlump = ds_source == NULL;
+#else
+        fromlump = true;
+#endif
+        if (fromlump)
+            ds_source = W_CacheLumpNum(lumpnum, PU_STATIC);
 
         planeheight = abs(pl->height-viewz);
         light = (pl->lightlevel >> LIGHTSEGSHIFT)+extralight;
@@ -486,6 +706,7 @@ void R_DrawPlanes (void)
                         pl->bottom[x]);
         }
 
-        W_ReleaseLumpNum(lumpnum);
+        if (fromlump)
+            W_ReleaseLumpNum(lumpnum);
     }
 }
@@ -29,6 +29,7 @@
 extern  short*      lastopening;
 
 
+
 typedef void (*planefunction_t) (int top, int bottom);
 
 extern planefunction_t  floorfunc;
@@ -37,12 +38,17 @@ extern planefunction_t  ceilingfunc_t;
 extern short        floorclip[SCREENWIDTH];
 extern short        ceilingclip[SCREENWIDTH];
 
-// extern fixed_t       yslope[SCREENHEIGHT];
-// extern fixed_t       distscale[SCREENWIDTH];
+extern const fixed_t *yslope;
+extern const fixed_t *distscale;
+extern const fixed_t yslope_const[SCREENHEIGHT];
+extern const fixed_t distscale_const[SCREENWIDTH];
 
 void R_InitPlanes (void);
 void R_ClearPlanes (void);
 
+// Log the most visplanes a frame wanted since the last call, once a level
+void R_ReportPlanes (void);
+
 void
 R_MapPlane
 ( int       y,
@@ -0,0 +1,236 @@
+//
+// Copyright(C) 2021 Nordic Semiconductor ASA
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Host benchmark of R_DrawPlanes on flat heavy views, not part of
+//      the firmware. Builds the visplanes of a few synthetic views and
+//      times drawing them, to weigh the R_SPANCACHE row cache against
+//      its RAM. Build it with and without the cache and compare:
+//
+//          SRC="r_plane_host.c r_plane.c r_draw.c ../m_fixed.c ../tables.c"
+//          cc -O2 -I. -I.. -I../config -DR_SPANCACHE=1 $SRC -lm
+//          ./a.out
+//
+//      then the same with -DR_SPANCACHE=0.
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "doomdef.h"
+#include "doomstat.h"
+#include "deh_str.h"
+#include "i_system.h"
+#include "i_video.h"
+#include "v_video.h"
+#include "w_wad.h"
+#include "z_zone.h"
+
+#include "r_local.h"
+#include "r_sky.h"
+
+#ifndef R_SPANCACHE
+#error Build with -DR_SPANCACHE=0 or 1
+#endif
+
+#define HOST_FRAMES     200
+#define HOST_RUNS       10
+
+// Stand-ins for what r_plane.c and r_draw.c use from the rest of the game
+pixel_t         host_screen[SCREENWIDTH*SCREENHEIGHT];
+pixel_t*        I_VideoBuffer = host_screen;
+int             centery = SCREENHEIGHT/2;
+fixed_t         centerxfrac = (SCREENWIDTH/2)<<FRACBITS;
+lighttable_t*   colormaps;
+lighttable_t*   zlight[LIGHTLEVELS][MAXLIGHTZ];
+lighttable_t*   fixedcolormap;
+int             extralight;
+int             detailshift;
+void            (*colfunc) (void);
+void            (*spanfunc) (void) = R_DrawSpan;
+GameMode_t      gamemode = shareware;
+drawseg_t       drawsegs[MAXDRAWSEGS];
+drawseg_t*      ds_p = drawsegs;
+fixed_t         pspriteiscale;
+fixed_t         viewx, viewy, viewz;
+angle_t         viewangle;
+const angle_t   *xtoviewangle;
+int             firstflat;
+short*          flattranslation;
+short           skyflatnum = -1;
+short           skytexture;
+int             skytexturemid;
+
+static angle_t          host_xtoviewangle[SCREENWIDTH+1];
+static short            host_flattranslation[4];
+static byte             host_flats[4][64*64];
+static lighttable_t     host_colormap[256];
+
+char *DEH_String(char *s) { return s; }
+void V_DrawPatch(int x, int y, patch_t *patch) {}
+void V_MarkRect(int x, int y, int width, int height) {}
+void V_UseBuffer(pixel_t *buffer) {}
+void V_RestoreBuffer(void) {}
+void *W_CacheLumpName(char *name, int tag) { return NULL; }
+void *W_CacheLumpNum(lumpindex_t lump, int tag) { return host_flats[lump]; }
+int W_LumpLength(lumpindex_t lump) { return 64*64; }
+void W_ReleaseLumpNum(lumpindex_t lump) {}
+void *Z_Malloc(int size, int tag, void *ptr) { return malloc(size); }
+void Z_Free(void *ptr) { free(ptr); }
+byte *R_GetCachedColumn(int tex, int col) { return NULL; }
+
+void I_Error(char *error, ...)
+{
+    printf("I_Error: %s\n", error);
+    exit(1);
+}
+
+//
+// Views. Heights are relative to the eye, floors below the horizon and
+// ceilings above it.
+//
+
+static void AddPlane(fixed_t height, int picnum, int lightlevel,
+                     int x1, int x2, int top, int bottom, int ragged)
+{
+    visplane_t *pl;
+    int x, t;
+
+    pl = R_FindPlane(height, picnum, lightlevel);
+    pl = R_CheckPlane(pl, x1, x2);
+
+    for (x = x1; x <= x2; x++)
+    {
+        // Pillars and steps cut into the plane every few columns
+        t = top + (ragged ? (x * 7) % ragged : 0);
+        pl->top[x] = t < bottom ? t : bottom;
+        pl->bottom[x] = bottom;
+    }
+}
+
+// One floor and one ceiling, a row is one span
+static void ViewOpenRoom(void)
+{
+    AddPlane(-41*FRACUNIT, 0, 160, 0, SCREENWIDTH-1,
+             centery+1, SCREENHEIGHT-1, 0);
+    AddPlane(88*FRACUNIT, 1, 160, 0, SCREENWIDTH-1,
+             0, centery-1, 0);
+}
+
+// A floor at one height split into sectors by light, side by side
+static void ViewLitPatches(void)
+{
+    int i;
+
+    for (i = 0; i < 12; i++)
+    {
+        AddPlane(-41*FRACUNIT, 0, 96 + i*8,
+                 i*SCREENWIDTH/12, (i+1)*SCREENWIDTH/12 - 1,
+                 centery+1, SCREENHEIGHT-1, 0);
+    }
+    AddPlane(88*FRACUNIT, 1, 160, 0, SCREENWIDTH-1, 0, centery-1, 0);
+}
+
+// Steps at four heights with pillars, several spans of a plane a row
+static void ViewStairs(void)
+{
+    int i;
+
+    for (i = 0; i < 8; i++)
+    {
+        AddPlane((-41 + (i%4)*8)*FRACUNIT, i%2, 128 + (i/4)*32,
+                 i*SCREENWIDTH/8, (i+1)*SCREENWIDTH/8 - 1,
+                 centery+1 + (i%4)*4, SCREENHEIGHT-1, 24);
+    }
+    AddPlane(88*FRACUNIT, 2, 160, 0, SCREENWIDTH-1, 0, centery-1, 40);
+}
+
+static double NowNS(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Best of HOST_RUNS, in us per frame. The planes are built again each
+// frame, only drawing them is timed.
+static double TimeView(void (*view)(void))
+{
+    double best = 0;
+    double total;
+    double start;
+    int run, frame;
+
+    for (run = 0; run < HOST_RUNS; run++)
+    {
+        total = 0;
+        for (frame = 0; frame < HOST_FRAMES; frame++)
+        {
+            viewangle = (angle_t) frame << 22;
+            R_ClearPlanes();
+            view();
+
+            start = NowNS();
+            R_DrawPlanes();
+            total += NowNS() - start;
+        }
+        total /= HOST_FRAMES * 1000.0;
+
+        if (run == 0 || total < best)
+            best = total;
+    }
+
+    return best;
+}
+
+int main(void)
+{
+    int i, j;
+
+    for (i = 0; i <= SCREENWIDTH; i++)
+    {
+        host_xtoviewangle[i] = (angle_t) (int)
+            (atan((SCREENWIDTH/2 - i) / (double) (SCREENWIDTH/2))
+             / (2*M_PI) * 4294967296.0);
+    }
+    xtoviewangle = host_xtoviewangle;
+
+    for (i = 0; i < 4; i++)
+    {
+        host_flattranslation[i] = i;
+        for (j = 0; j < 64*64; j++)
+            host_flats[i][j] = rand();
+    }
+    flattranslation = host_flattranslation;
+
+    for (i = 0; i < 256; i++)
+        host_colormap[i] = rand();
+    for (i = 0; i < LIGHTLEVELS; i++)
+        for (j = 0; j < MAXLIGHTZ; j++)
+            zlight[i][j] = host_colormap;
+
+    viewwidth = SCREENWIDTH;
+    viewheight = SCREENHEIGHT;
+    R_InitBuffer(SCREENWIDTH, SCREENHEIGHT);
+    R_InitPlanes();
+
+    printf("R_SPANCACHE=%d, us per frame of R_DrawPlanes\n", R_SPANCACHE);
+    printf("  open room    %7.1f\n", TimeView(ViewOpenRoom));
+    printf("  lit patches  %7.1f\n", TimeView(ViewLitPatches));
+    printf("  stairs       %7.1f\n", TimeView(ViewStairs));
+
+    return 0;
+}
@@ -47,6 +47,14 @@ int             toptexture;
 int             bottomtexture;
 int             midtexture;
 
+// Columns of the textures above, and the drawers for their heights
+static texcolumns_t toptexcols;
+static texcolumns_t bottomtexcols;
+static texcolumns_t midtexcols;
+static void         (*topcolfunc) (void);
+static void         (*bottomcolfunc) (void);
+static void         (*midcolfunc) (void);
+
 
 angle_t         rw_normalangle;
 // angle to line origin
@@ -302,10 +310,12 @@ void R_RenderSegLoop (void)
             if (index >=  MAXLIGHTSCALE )
                 index = MAXLIGHTSCALE-1;
 
-            //NRFD-TODO: Optimize
             dc_colormap = walllights[index];
             dc_x = rw_x;
-            dc_iscale = 0xffffffffu / (unsigned)rw_scale;
+
+            // NRFD-NOTE: Divided only when a tier is drawn, many
+            // columns are fully clipped.
+            dc_iscale = 0;
         }
         else
         {
@@ -320,9 +330,14 @@ void R_RenderSegLoop (void)
             // single sided line
             dc_yl = yl;
             dc_yh = yh;
-            dc_texturemid = rw_midtexturemid;
-            dc_source = R_GetCachedColumn(midtexture,texturecolumn);
-            colfunc ();
+            if (yl <= yh)
+            {
+                dc_texturemid = rw_midtexturemid;
+                dc_source = R_TextureColumn(&midtexcols, texturecolumn);
+                dc_texheight = midtexcols.height;
+                dc_iscale = 0xffffffffu / (unsigned)rw_scale;
+                midcolfunc ();
+            }
             ceilingclip[rw_x] = viewheight;
             floorclip[rw_x] = -1;
         }
@@ -343,8 +358,10 @@ void R_RenderSegLoop (void)
                     dc_yl = yl;
                     dc_yh = mid;
                     dc_texturemid = rw_toptexturemid;
-                    dc_source = R_GetCachedColumn(toptexture,texturecolumn);
-                    colfunc ();
+                    dc_source = R_TextureColumn(&toptexcols, texturecolumn);
+                    dc_texheight = toptexcols.height;
+                    dc_iscale = 0xffffffffu / (unsigned)rw_scale;
+                    topcolfunc ();
                     ceilingclip[rw_x] = mid;
                 }
                 else
@@ -372,9 +389,12 @@ void R_RenderSegLoop (void)
                     dc_yl = mid;
                     dc_yh = yh;
                     dc_texturemid = rw_bottomtexturemid;
-                    dc_source = R_GetCachedColumn(bottomtexture,
-                                            texturecolumn);
-                    colfunc ();
+                    dc_source = R_TextureColumn(&bottomtexcols,
+                                                texturecolumn);
+                    dc_texheight = bottomtexcols.height;
+                    if (!dc_iscale)
+                        dc_iscale = 0xffffffffu / (unsigned)rw_scale;
+                    bottomcolfunc ();
                     floorclip[rw_x] = mid;
                 }
                 else
@@ -643,6 +663,23 @@ R_StoreWallRange
     // calculate rw_offset (only needed for textured lines)
     segtextured = midtexture | toptexture | bottomtexture | maskedtexture;
 
+    // Textures 128 high, nearly all of them, wrap with the mask in colfunc
+    if (midtexture)
+    {
+        R_GetTextureColumns(midtexture, &midtexcols);
+        midcolfunc = midtexcols.height == 128 ? colfunc : tallcolfunc;
+    }
+    if (toptexture)
+    {
+        R_GetTextureColumns(toptexture, &toptexcols);
+        topcolfunc = toptexcols.height == 128 ? colfunc : tallcolfunc;
+    }
+    if (bottomtexture)
+    {
+        R_GetTextureColumns(bottomtexture, &bottomtexcols);
+        bottomcolfunc = bottomtexcols.height == 128 ? colfunc : tallcolfunc;
+    }
+
     if (segtextured)
     {
         offsetangle = rw_normalangle-rw_angle1;
@@ -104,8 +104,8 @@ extern player_t*        viewplayer;
 // ?
 extern angle_t          clipangle;
 
-extern const int        viewangletox[FINEANGLES/2];
-extern const angle_t    xtoviewangle[SCREENWIDTH+1];
+extern const short      *viewangletox;
+extern const angle_t    *xtoviewangle;
 //extern fixed_t                finetangent[FINEANGLES/2];
 
 extern fixed_t          rw_distance;
@@ -103,7 +103,10 @@ const short           negonearray[SCREENWIDTH] = {
     -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
     -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
     -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1};
-const short           screenheightarray[SCREENWIDTH] = {
+// NRFD-NOTE: Points to screenheightarray_const, or to a table in RAM
+// for view sizes other than the default.
+const short           *screenheightarray = screenheightarray_const;
+const short           screenheightarray_const[SCREENWIDTH] = {
     168, 168, 168, 168, 168, 168, 168, 168, 168, 168, 168, 168, 168, 168, 168, 168,
     168, 168, 168, 168, 168, 168, 168, 168, 168, 168, 168, 168, 168, 168, 168, 168,
     168, 168, 168, 168, 168, 168, 168, 168, 168, 168, 168, 168, 168, 168, 168, 168,
@@ -500,14 +503,17 @@ R_DrawVisSprite
         // NULL colormap = shadow draw
         colfunc = fuzzcolfunc;
     }
-    /* NRFD_TODO: translation
-    else if (vis->thing->flags & MF_TRANSLATION)
+    else if (vis->thing && (vis->thing->flags & MF_TRANSLATION))
     {
         colfunc = transcolfunc;
-        dc_translation = translationtables - 256 +
-            ( (vis->thing->flags & MF_TRANSLATION) >> (MF_TRANSSHIFT-8) );
+        dc_translation = R_TranslationColormap (translationtables - 256 +
+            ( (vis->thing->flags & MF_TRANSLATION) >> (MF_TRANSSHIFT-8) ),
+            dc_colormap);
+    }
+    else
+    {
+        colfunc = postcolfunc;
     }
-    */
 
     dc_iscale = abs(vis->xiscale)>>detailshift;
     dc_texturemid = vis->texturemid;
@@ -800,6 +806,7 @@ void R_DrawPSprite (pspdef_t* psp)
     // store information in a vissprite
     vis = &avis;
     // vis->mobjflags = 0; // NRFD-TODO?
+    vis->thing = NULL;
     vis->texturemid = (BASEYCENTER<<FRACBITS)+FRACUNIT/2-(psp->sy-R_SpriteTopOffset(lump));
     vis->x1 = x1 < 0 ? 0 : x1;
     vis->x2 = x2 >= viewwidth ? viewwidth-1 : x2;
@@ -888,90 +895,86 @@ void R_DrawPlayerSprites (void)
 
 
 //
-// R_SortVisSprites
+// R_MergeVisSprites
+// Merge two lists sorted by scale, the sprites of a first on ties.
+// vissprite_t is packed, so the list is built from a dummy head rather
+// than through a pointer to a next field.
 //
-
-
-void R_SortVisSprites (void)
+static vissprite_t *R_MergeVisSprites (vissprite_t *a, vissprite_t *b)
 {
-    int count = vissprite_p - vissprites;
-    // printf("R_SortVisSprites: %d\n", count);
-    // NRFD-NOTE: Completely rewritten for singly-linked list
-    // printf("R_SortVisSprites: %d\n", count);
-
-    // Initialize sorted list
-    vsprsortedhead = &vissprites[0];
-    vsprsortedhead->next = NULL;
+    vissprite_t         head;
+    vissprite_t*        tail = &head;
 
-    if (count < 2) return;
-
-    // Insert items into list in semi-sorted order
-    for (int i=1 ; i<count ; i++)
+    while (a != NULL && b != NULL)
     {
-        vissprite_t*   ds = &vissprites[i];
-        vissprite_t*   comp = vsprsortedhead;
-
-        while (comp != NULL) {
-            vissprite_t*   next = comp->next;
-            if ((ds->scale > comp->scale) || (next == NULL)) {
-                // Insert after comp
-                ds->next = comp->next;
-                comp->next = ds;
-                break;
-            }
-            comp = next;
+        if (b->scale < a->scale)
+        {
+            tail->next = b;
+            b = b->next;
+        }
+        else
+        {
+            tail->next = a;
+            a = a->next;
         }
+        tail = tail->next;
     }
+    tail->next = a != NULL ? a : b;
 
-    if (count < 3) return;
+    return head.next;
+}
+
+
+//
+// R_SortVisSprites
+// NRFD-NOTE: Bottom up merge sort of the singly-linked list. Level i holds
+// a sorted run of 2^i sprites, or nothing. The sort is stable, so sprites
+// of the same scale are drawn in the order vanilla Doom draws them.
+//
+#define SORTLEVELS      8       // Enough for 255 vissprites
 
-    // Bubble sort
-    boolean sorted = false;
-    while (!sorted) {
-        sorted = true;
+void R_SortVisSprites (void)
+{
+    int                 count = vissprite_p - vissprites;
+    vissprite_t*        levels[SORTLEVELS];
+    vissprite_t*        ds;
+    int                 i;
+    int                 level;
 
-        vissprite_t    dummy_head;
-        vissprite_t*   prev = &dummy_head;
-        vissprite_t*   ds = vsprsortedhead;
+    memset (levels, 0, sizeof(levels));
 
-        dummy_head.next = vsprsortedhead;
+    for (i=0 ; i<count ; i++)
+    {
+        ds = &vissprites[i];
+        ds->next = NULL;
 
-        while (ds->next != NULL) {
-            vissprite_t*   next = ds->next;
-            if (ds->scale > next->scale) {
-                // Swap
-                prev->next = next;
-                ds->next = next->next;
-                next->next = ds;
-                sorted = false;
-            }
-            else {
-                ds = next;
-            }
-            prev = prev->next;
+        for (level=0 ; levels[level] != NULL ; level++)
+        {
+            ds = R_MergeVisSprites (levels[level], ds);
+            levels[level] = NULL;
         }
-        vsprsortedhead = dummy_head.next;
+        levels[level] = ds;
     }
 
-    // printf("  ");
-    vissprite_t*        spr;
-    int count2 = 0;
-    for (spr = vsprsortedhead ;
-         spr != NULL ;
-         spr=spr->next)
+    // Lower levels hold later sprites
+    vsprsortedhead = NULL;
+    for (level=0 ; level<SORTLEVELS ; level++)
     {
-        count2++;
-        // printf("%d ", spr->scale);
-        if (spr->next && (spr->next->scale < spr->scale)) {
-            printf("\n%d %d\n", spr->scale, spr->next->scale);
-            I_Error("R_SortVisSprites: sort failed order");
-        }
-    }
-    // printf("\n");
-    if (count != count2) {
-        I_Error("R_SortVisSprites: sort failed count");
+        if (levels[level] != NULL)
+            vsprsortedhead = R_MergeVisSprites (levels[level], vsprsortedhead);
     }
 
+#ifdef RANGECHECK
+    i = 0;
+    for (ds = vsprsortedhead ; ds != NULL ; ds = ds->next)
+    {
+        i++;
+        if (ds->next && ds->next->scale < ds->scale)
+            I_Error ("R_SortVisSprites: sort failed order");
+    }
+    if (i != count)
+        I_Error ("R_SortVisSprites: sort failed count");
+#endif
 }
 
 
@@ -979,11 +982,21 @@ void R_SortVisSprites (void)
 //
 // R_DrawSprite
 //
+
+// NRFD-NOTE: Shared by all sprites rather than on the stack, only the
+// columns of the sprite drawn are used. CONFIG_MAIN_STACK_SIZE in prj.conf
+// was lowered by their 1280 bytes, grow it again if they go back.
+static short            clipbot[SCREENWIDTH];
+static short            cliptop[SCREENWIDTH];
+
+// Drawsegs that can clip a sprite or hide behind one, found once a frame
+static byte             spritesegs[MAXDRAWSEGS];
+static int              numspritesegs;
+
 void R_DrawSprite (vissprite_t* spr)
 {
     drawseg_t*          ds;
-    short               clipbot[SCREENWIDTH];
-    short               cliptop[SCREENWIDTH];
+    int                 i;
     int                 x;
     int                 r1;
     int                 r2;
@@ -1002,13 +1015,13 @@ void R_DrawSprite (vissprite_t* spr)
     // Scan drawsegs from end to start for obscuring segs.
     // The first drawseg that has a greater scale
     //  is the clip seg.
-    for (ds=ds_p-1 ; ds >= drawsegs ; ds--)
+    for (i=numspritesegs-1 ; i >= 0 ; i--)
     {
+        ds = &drawsegs[spritesegs[i]];
+
         // determine if the drawseg obscures the sprite
         if (ds->x1 > spr->x2
-            || ds->x2 < spr->x1
-            || (!ds->silhouette
-                && !ds->maskedtexturecol) )
+            || ds->x2 < spr->x1)
         {
             // does not cover sprite
             continue;
@@ -1110,6 +1123,15 @@ void R_DrawMasked (void)
 
     if (vissprite_p > vissprites)
     {
+        // Only drawsegs with a silhouette or a masked mid texture
+        //  can obscure a sprite.
+        numspritesegs = 0;
+        for (ds=drawsegs ; ds < ds_p ; ds++)
+        {
+            if (ds->silhouette || ds->maskedtexturecol)
+                spritesegs[numspritesegs++] = ds - drawsegs;
+        }
+
         // draw all vissprites back to front
         N_ldbg("R_DrawMasked\n");
 
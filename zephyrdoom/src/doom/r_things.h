@@ -21,8 +21,10 @@
 #define __R_THINGS__
 
 // NRFD-TODO:
+#ifndef MAXVISSPRITES
 #define MAXVISSPRITES   64
 // #define MAXVISSPRITES   128
+#endif
 
 extern vissprite_t      vissprites[MAXVISSPRITES];
 extern vissprite_t*     vissprite_p;
@@ -31,7 +33,8 @@ extern vissprite_t*     vissprite_p;
 // Constant arrays used for psprite clipping
 //  and initializing clipping.
 extern const short      negonearray[SCREENWIDTH];
-extern const short      screenheightarray[SCREENWIDTH];
+extern const short      *screenheightarray;
+extern const short      screenheightarray_const[SCREENWIDTH];
 
 // vars for R_DrawMaskedColumn
 extern short*           mfloorclip;
@@ -0,0 +1,272 @@
+//
+// Copyright(C) 2021 Nordic Semiconductor ASA
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Host benchmark of R_SortVisSprites, not part of the firmware.
+//      Sorts synthetic sets of 16, 64 and 128 vissprites with the merge
+//      sort and with the insertion and bubble sort it replaced, checks
+//      the order, count and stability of the result, and prints the
+//      time per sort.
+//
+//      Build and run from this directory:
+//
+//          SRC="r_things_host.c r_things.c ../m_fixed.c"
+//          cc -O2 -I. -I.. -I../config -DMAXVISSPRITES=128 $SRC
+//          ./a.out
+//
+//      The relative numbers are what matter. For target numbers, build
+//      the same file with the board's compiler flags and run it there.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "doomdef.h"
+#include "doomstat.h"
+#include "deh_str.h"
+#include "i_system.h"
+#include "w_wad.h"
+
+#include "r_local.h"
+
+#if MAXVISSPRITES < 128
+#error Build with -DMAXVISSPRITES=128
+#endif
+
+#define HOST_SORTS      2000
+#define HOST_RUNS       10
+
+// Stand-ins for what r_things.c uses from the rest of the game
+const boolean   modifiedgame;
+const char* const sprnames[] = { NULL };
+int             viewangleoffset;
+int             firstspritelump, lastspritelump;
+int             viewwidth, viewheight;
+int             detailshift;
+int             extralight;
+uint8_t         validcount;
+fixed_t         viewx, viewy, viewz;
+fixed_t         viewcos, viewsin;
+fixed_t         centerxfrac, centeryfrac;
+fixed_t         projection;
+player_t*       viewplayer;
+lighttable_t*   colormaps;
+lighttable_t*   fixedcolormap;
+lighttable_t*   scalelight[LIGHTLEVELS][MAXLIGHTSCALE];
+byte*           translationtables;
+drawseg_t       drawsegs[MAXDRAWSEGS];
+drawseg_t*      ds_p = drawsegs;
+lighttable_t*   dc_colormap;
+int             dc_x, dc_yl, dc_yh;
+fixed_t         dc_iscale;
+fixed_t         dc_texturemid;
+byte*           dc_source;
+byte*           dc_translation;
+boolean         dc_debug;
+void            (*colfunc) (void);
+void            (*transcolfunc) (void);
+void            (*basecolfunc) (void);
+void            (*fuzzcolfunc) (void);
+void            (*postcolfunc) (void);
+
+char *DEH_String(char *s) { return s; }
+void *W_CacheLumpNum(lumpindex_t lump, int tag) { return NULL; }
+lumpindex_t W_GetNumForName(const char *name) { return 0; }
+char *W_LumpName(lumpindex_t lump) { return ""; }
+fixed_t R_SpriteWidth(int num) { return 0; }
+fixed_t R_SpriteOffset(int num) { return 0; }
+fixed_t R_SpriteTopOffset(int num) { return 0; }
+int R_PointOnSegSide(fixed_t x, fixed_t y, seg_t *line) { return 0; }
+angle_t R_PointToAngle(fixed_t x, fixed_t y) { return 0; }
+void R_RenderMaskedSegRange(drawseg_t *ds, int x1, int x2) {}
+
+byte *R_TranslationColormap(const byte *translation,
+                            const lighttable_t *colormap)
+{
+    return NULL;
+}
+
+void I_Error(char *error, ...)
+{
+    printf("I_Error: %s\n", error);
+    exit(1);
+}
+
+extern vissprite_t*     vsprsortedhead;
+
+//
+// The sort R_SortVisSprites replaced: insert each sprite in front of
+// the first smaller one, then bubble sort what is left out of order.
+//
+
+static void BaseSortVisSprites(void)
+{
+    int count = vissprite_p - vissprites;
+    boolean sorted;
+    vissprite_t dummy_head;
+    vissprite_t *prev, *ds, *comp, *next;
+    int i;
+
+    vsprsortedhead = &vissprites[0];
+    vsprsortedhead->next = NULL;
+
+    if (count < 2) return;
+
+    for (i=1 ; i<count ; i++)
+    {
+        ds = &vissprites[i];
+        comp = vsprsortedhead;
+
+        while (comp != NULL)
+        {
+            next = comp->next;
+            if ((ds->scale > comp->scale) || (next == NULL))
+            {
+                ds->next = comp->next;
+                comp->next = ds;
+                break;
+            }
+            comp = next;
+        }
+    }
+
+    if (count < 3) return;
+
+    sorted = false;
+    while (!sorted)
+    {
+        sorted = true;
+        prev = &dummy_head;
+        ds = vsprsortedhead;
+        dummy_head.next = vsprsortedhead;
+
+        while (ds->next != NULL)
+        {
+            next = ds->next;
+            if (ds->scale > next->scale)
+            {
+                prev->next = next;
+                ds->next = next->next;
+                next->next = ds;
+                sorted = false;
+            }
+            else
+            {
+                ds = next;
+            }
+            prev = prev->next;
+        }
+        vsprsortedhead = dummy_head.next;
+    }
+}
+
+//
+// Synthetic sprite sets. Scales are drawn from a few distinct values so
+// that sets have ties, as sprites standing at the same distance do.
+//
+
+static void MakeSprites(int count, int distinct)
+{
+    int i;
+
+    vissprite_p = vissprites;
+    for (i = 0; i < count; i++)
+    {
+        vissprite_p->scale = FRACUNIT/8 + (rand() % distinct) * (FRACUNIT/4);
+        vissprite_p->x1 = i;
+        vissprite_p++;
+    }
+}
+
+// Count and order for both sorts, stability for the merge sort only as
+// the old sort did not keep the order of ties
+static boolean Check(boolean stable)
+{
+    vissprite_t *ds;
+    int count = 0;
+
+    for (ds = vsprsortedhead; ds != NULL; ds = ds->next)
+    {
+        count++;
+        if (ds->next == NULL)
+            break;
+        if (ds->next->scale < ds->scale)
+            return false;
+        if (stable && ds->next->scale == ds->scale && ds->next->x1 < ds->x1)
+            return false;
+    }
+
+    return count == vissprite_p - vissprites;
+}
+
+static double NowNS(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Best of HOST_RUNS, in us per sort. The set is sorted again from
+// vissprites order each time, as R_DrawMasked does every frame.
+static double Time(void (*sort)(void))
+{
+    double best = 0;
+    double start, time;
+    int run, n;
+
+    for (run = 0; run < HOST_RUNS; run++)
+    {
+        start = NowNS();
+        for (n = 0; n < HOST_SORTS; n++)
+            sort();
+        time = (NowNS() - start) / (HOST_SORTS * 1000.0);
+
+        if (run == 0 || time < best)
+            best = time;
+    }
+
+    return best;
+}
+
+static void Compare(int count, int distinct)
+{
+    boolean sorted;
+
+    MakeSprites(count, distinct);
+
+    R_SortVisSprites();
+    sorted = Check(true);
+    BaseSortVisSprites();
+    sorted = sorted && Check(false);
+
+    printf("%5d %9d  %8.2f  %13.2f%s\n", count, distinct,
+           Time(R_SortVisSprites), Time(BaseSortVisSprites),
+           sorted ? "" : "  SORT FAILED");
+}
+
+int main(void)
+{
+    static const int counts[] = { 16, 64, 128 };
+    unsigned int i;
+
+    printf("count  distinct  us/sort  baseline us/sort\n");
+    for (i = 0; i < sizeof(counts)/sizeof(counts[0]); i++)
+    {
+        Compare(counts[i], counts[i]);
+        Compare(counts[i], 4);
+    }
+
+    return 0;
+}
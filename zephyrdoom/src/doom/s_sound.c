@@ -239,7 +239,6 @@ void S_Start(void)
         }
     }
 
-/* NRFD-TODO: Music?
     // start new music for the level
     mus_paused = 0;
 
@@ -275,7 +274,6 @@ void S_Start(void)
     }
 
     S_ChangeMusic(mnum, true);
-    */
 }
 
 void S_StopSound(mobj_t *origin)
@@ -551,26 +549,20 @@ void S_StartSound(void *origin_p, int sfx_id)
 
 void S_PauseSound(void)
 {
-    printf("NRFD-TODO: S_PauseSound\n");
-    /*
     if (mus_playing && !mus_paused)
     {
         I_PauseSong();
         mus_paused = true;
     }
-    */
 }
 
 void S_ResumeSound(void)
 {
-    printf("NRFD-TODO: S_ResumeSound\n");
-    /*
     if (mus_playing && mus_paused)
     {
         I_ResumeSong();
         mus_paused = false;
     }
-    */
 }
 
 //
@@ -677,8 +669,6 @@ void S_StartMusic(int m_id)
 
 void S_ChangeMusic(int musicnum, int looping)
 {
-    printf("NRFD-TODO: S_ChangeMusic\n");
-    /*
     musicinfo_t *music = NULL;
     char namebuf[9];
     void *handle;
@@ -723,7 +713,6 @@ void S_ChangeMusic(int musicnum, int looping)
     I_PlaySong(handle, looping);
 
     mus_playing = music;
-    */
 }
 
 boolean S_MusicPlaying(void)
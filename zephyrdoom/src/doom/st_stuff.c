@@ -424,7 +424,7 @@ void ST_refreshBackground(void)
         if (netgame)
             V_DrawPatch(ST_FX, 0, faceback);
 
-        V_RestoreBuffer();
+        V_UseBuffer(I_StatusBarScreen);
 
         V_CopyRect(ST_X, 0, st_backing_screen, ST_WIDTH, ST_HEIGHT, ST_X, ST_Y);
     }
@@ -1083,13 +1083,21 @@ void ST_Drawer (boolean fullscreen, boolean refresh)
     // Do red-/gold-shifts from damage/items
     ST_doPaletteStuff();
 
-    st_firsttime = true; // NRFD-TODO: remove
+    // NRFD-NOTE: The status bar is drawn into its own layer, which keeps
+    // its contents between frames.
+    V_UseBuffer(I_StatusBarScreen);
 
     // If just after ST_Start(), refresh all
     if (st_firsttime) ST_doRefresh();
     // Otherwise, update as little as possible
     else ST_diffDraw();
 
+    V_RestoreBuffer();
+
+    // Copy the layer into the frame unless the display composites it
+    if (st_statusbaron && !I_StatusBarLayerEnabled())
+        V_CopyRect(ST_X, 0, I_StatusBarBuffer, ST_WIDTH, ST_HEIGHT, ST_X, ST_Y);
+
 }
 
 typedef void (*load_callback_t)(char *lumpname, patch_t **variable);
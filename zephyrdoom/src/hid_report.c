@@ -0,0 +1,684 @@
+//
+// Copyright(C) 2021 Nordic Semiconductor ASA
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      HID report map parsing and input report decoding.
+//
+
+#include "hid_report.h"
+
+#include <string.h>
+
+#include "d_event.h"
+#include "doomkeys.h"
+#include "m_controls.h"
+
+// Joystick event axes run to +-HID_STICK_OUT
+#define HID_STICK_OUT 65
+
+#define STICK_DEAD (HID_STICK_DEAD_ZONE * HID_AXIS_FULL / 100)
+#define TRIGGER_DEAD (HID_TRIGGER_DEAD_ZONE * HID_AXIS_FULL / 100)
+
+// Stretches what is left past the dead zone back to full travel, 16.16,
+// rounded up so that full travel stays full
+#define STICK_STRETCH                                              \
+    (((HID_AXIS_FULL << 16) + HID_AXIS_FULL - STICK_DEAD - 1) /    \
+     (HID_AXIS_FULL - STICK_DEAD))
+
+// Stick response past the dead zone, in 16 steps of travel. Linear;
+// change for a finer centre.
+static const uint8_t stick_curve_const[17] = {
+    0,  4,  8,  12, 16, 20, 24, 28, 33, 37, 41, 45, 49, 53, 57, 61, 65,
+};
+
+// HID keyboard usages to Doom keys
+static const uint8_t hid_keys_const[256] = SCANCODE_TO_KEYS_ARRAY;
+
+// Modifier byte bits: left then right ctrl, shift, alt, gui
+static const uint8_t hid_modifiers_const[8] = {
+    KEY_RCTRL, KEY_RSHIFT, KEY_RALT, 0, KEY_RCTRL, KEY_RSHIFT, KEY_RALT, 0,
+};
+
+// Gamepad buttons, in HID button order as on an Xbox controller: a
+// joystick button bit, or a key.
+typedef struct {
+    int8_t joyb;
+    int *key;
+} hid_button_t;
+
+static const hid_button_t gamepad_buttons_const[HID_GAMEPAD_BUTTONS] = {
+    {4, NULL},                // A
+    {5, NULL},                // B
+    {-1, NULL},
+    {2, NULL},                // X
+    {3, NULL},                // Y
+    {-1, NULL},
+    {-1, NULL},               // LB
+    {-1, NULL},               // RB
+    {-1, NULL},
+    {-1, NULL},
+    {-1, &key_map_toggle},    // View
+    {-1, &key_menu_activate}, // Menu
+    {-1, NULL},
+    {-1, NULL},
+    {-1, NULL},
+    {-1, NULL},
+};
+
+//
+// Report map parsing
+//
+
+#define HID_MAX_USAGES 16
+#define HID_MAX_REPORTS 8
+#define HID_STACK_DEPTH 2
+
+#define HID_PAGE_DESKTOP 0x01
+#define HID_PAGE_SIMULATION 0x02
+#define HID_PAGE_KEYBOARD 0x07
+#define HID_PAGE_BUTTON 0x09
+
+#define HID_INPUT_CONSTANT 0x01
+#define HID_INPUT_VARIABLE 0x02
+
+typedef struct {
+    uint16_t usage_page;
+    int32_t logical_min;
+    int32_t logical_max_signed;
+    uint32_t logical_max_unsigned;
+    uint8_t report_size;
+    uint8_t report_count;
+    uint8_t report_id;
+} hid_globals_t;
+
+typedef struct {
+    hid_globals_t globals;
+    hid_globals_t stack[HID_STACK_DEPTH];
+    int stack_depth;
+
+    // Usages of the next main item. The page is 0 where it is to be taken
+    // from the globals.
+    uint32_t usages[HID_MAX_USAGES];
+    int num_usages;
+    uint32_t usage_min;
+    uint32_t usage_max;
+
+    // Bits of input seen so far in each report
+    uint8_t report_ids[HID_MAX_REPORTS];
+    uint16_t report_bits[HID_MAX_REPORTS];
+    int num_reports;
+} hid_parser_t;
+
+// Report state from the last report, to post changes only
+static uint8_t prev_modifiers;
+static uint8_t prev_keys[HID_MAX_USAGES];
+static uint32_t prev_buttons;
+static boolean prev_hat_up, prev_hat_down;
+static int prev_brake, prev_accel;
+static event_t prev_joystick_event;
+
+static void ResetState(void) {
+    prev_modifiers = 0;
+    memset(prev_keys, 0, sizeof(prev_keys));
+    prev_buttons = 0;
+    prev_hat_up = prev_hat_down = false;
+    prev_brake = prev_accel = 0;
+    memset(&prev_joystick_event, 0, sizeof(prev_joystick_event));
+}
+
+static void ClearLocals(hid_parser_t *p) {
+    p->num_usages = 0;
+    p->usage_min = p->usage_max = 0;
+}
+
+static uint16_t *ReportBits(hid_parser_t *p, uint8_t report_id) {
+    int i;
+
+    for (i = 0; i < p->num_reports; i++) {
+        if (p->report_ids[i] == report_id) {
+            return &p->report_bits[i];
+        }
+    }
+
+    if (p->num_reports == HID_MAX_REPORTS) {
+        return NULL;
+    }
+
+    p->report_ids[i] = report_id;
+    p->report_bits[i] = 0;
+    p->num_reports++;
+
+    return &p->report_bits[i];
+}
+
+static uint32_t UsageAt(const hid_parser_t *p, int index) {
+    uint32_t usage;
+
+    if (p->num_usages > 0) {
+        usage = p->usages[index < p->num_usages ? index : p->num_usages - 1];
+    } else if (p->usage_max > p->usage_min) {
+        usage = p->usage_min + index;
+        if (usage > p->usage_max) {
+            usage = p->usage_max;
+        }
+    } else {
+        usage = p->usage_min;
+    }
+
+    if ((usage >> 16) == 0) {
+        usage |= (uint32_t)p->globals.usage_page << 16;
+    }
+
+    return usage;
+}
+
+static void SetField(hid_field_t *field, const hid_parser_t *p,
+                     uint16_t bit_offset) {
+    const hid_globals_t *g = &p->globals;
+
+    field->bit_offset = bit_offset;
+    field->size = g->report_size;
+    field->report_id = g->report_id;
+    field->is_signed = g->logical_min < 0;
+    field->logical_min = g->logical_min;
+    field->logical_max = g->logical_min < 0 ? g->logical_max_signed
+                                            : (int32_t)g->logical_max_unsigned;
+}
+
+// A single value of a variable input item
+static void AddVariable(hid_layout_t *layout, const hid_parser_t *p,
+                        uint32_t usage, uint16_t bit_offset) {
+    uint16_t page = usage >> 16;
+    uint16_t id = usage & 0xFFFF;
+    hid_field_t *field = NULL;
+
+    if (p->globals.report_size == 0 || p->globals.report_size > 32) {
+        return;
+    }
+
+    if (page == HID_PAGE_DESKTOP) {
+        if (id == 0x30) {
+            field = &layout->axes[HID_AXIS_X];
+        } else if (id == 0x31) {
+            field = &layout->axes[HID_AXIS_Y];
+        } else if (id == 0x39) {
+            field = &layout->hat;
+        }
+    } else if (page == HID_PAGE_SIMULATION) {
+        if (id == 0xC4) {
+            field = &layout->axes[HID_AXIS_ACCEL];
+        } else if (id == 0xC5) {
+            field = &layout->axes[HID_AXIS_BRAKE];
+        }
+    } else if (page == HID_PAGE_BUTTON && p->globals.report_size == 1) {
+        // Buttons are kept as one bit field, from button 1 on
+        hid_field_t *buttons = &layout->buttons;
+
+        if (id == 1 && buttons->size == 0) {
+            SetField(buttons, p, bit_offset);
+        } else if (buttons->size > 0 && id == buttons->size + 1 &&
+                   id <= HID_GAMEPAD_BUTTONS &&
+                   bit_offset == buttons->bit_offset + buttons->size &&
+                   p->globals.report_id == buttons->report_id) {
+            buttons->size++;
+        }
+        return;
+    } else if (page == HID_PAGE_KEYBOARD && id == 0xE0 &&
+               p->globals.report_size == 1) {
+        SetField(&layout->modifiers, p, bit_offset);
+        layout->modifiers.size = 8;
+        return;
+    }
+
+    if (field != NULL && field->size == 0) {
+        SetField(field, p, bit_offset);
+    }
+}
+
+static void AddInput(hid_layout_t *layout, hid_parser_t *p, uint32_t flags) {
+    const hid_globals_t *g = &p->globals;
+    uint16_t *bits = ReportBits(p, g->report_id);
+    int i;
+
+    if (bits == NULL) {
+        return;
+    }
+
+    if (flags & HID_INPUT_CONSTANT) {
+        // Padding
+    } else if (flags & HID_INPUT_VARIABLE) {
+        for (i = 0; i < g->report_count; i++) {
+            AddVariable(layout, p, UsageAt(p, i), *bits + i * g->report_size);
+        }
+    } else if ((UsageAt(p, 0) >> 16) == HID_PAGE_KEYBOARD &&
+               layout->keys.size == 0 && g->report_size <= 8) {
+        // Array of the keys held down
+        SetField(&layout->keys, p, *bits);
+        layout->key_count = g->report_count < HID_MAX_USAGES
+                                ? g->report_count
+                                : HID_MAX_USAGES;
+    }
+
+    *bits += g->report_size * g->report_count;
+}
+
+static void ScaleAxes(hid_layout_t *layout) {
+    for (int i = 0; i < HID_NUM_AXES; i++) {
+        const hid_field_t *field = &layout->axes[i];
+        int64_t range = (int64_t)field->logical_max - field->logical_min;
+
+        if (field->size == 0 || range <= 0) {
+            continue;
+        }
+
+        if (i == HID_AXIS_X || i == HID_AXIS_Y) {
+            // Centred, half the range each way
+            layout->axis_centre[i] = field->logical_min + range / 2;
+            range /= 2;
+            if (range == 0) {
+                range = 1;
+            }
+        } else {
+            layout->axis_centre[i] = field->logical_min;
+        }
+
+        layout->axis_scale[i] = ((int64_t)HID_AXIS_FULL << 16) / range;
+    }
+}
+
+boolean hid_report_parse_map(const uint8_t *map, size_t len,
+                             hid_layout_t *layout) {
+    static hid_parser_t parser;
+    hid_parser_t *p = &parser;
+    size_t pos = 0;
+
+    memset(layout, 0, sizeof(*layout));
+    memset(p, 0, sizeof(*p));
+    ResetState();
+
+    while (pos < len) {
+        uint8_t prefix = map[pos++];
+        int size = prefix & 3;
+        uint32_t uvalue = 0;
+        int32_t svalue;
+
+        if (prefix == 0xFE) {
+            // Long item, not used by any of the tags handled here
+            if (pos < len) {
+                pos += 2 + map[pos];
+            }
+            continue;
+        }
+
+        if (size == 3) {
+            size = 4;
+        }
+        if (pos + size > len) {
+            break;
+        }
+        for (int i = size - 1; i >= 0; i--) {
+            uvalue = (uvalue << 8) | map[pos + i];
+        }
+        pos += size;
+
+        svalue = uvalue;
+        if (size == 1) {
+            svalue = (int8_t)uvalue;
+        } else if (size == 2) {
+            svalue = (int16_t)uvalue;
+        }
+
+        switch (prefix & 0xFC) {
+        // Global items
+        case 0x04:
+            p->globals.usage_page = uvalue;
+            break;
+        case 0x14:
+            p->globals.logical_min = svalue;
+            break;
+        case 0x24:
+            p->globals.logical_max_signed = svalue;
+            p->globals.logical_max_unsigned = uvalue;
+            break;
+        case 0x74:
+            p->globals.report_size = uvalue;
+            break;
+        case 0x84:
+            p->globals.report_id = uvalue;
+            break;
+        case 0x94:
+            p->globals.report_count = uvalue;
+            break;
+        case 0xA4:
+            if (p->stack_depth < HID_STACK_DEPTH) {
+                p->stack[p->stack_depth++] = p->globals;
+            }
+            break;
+        case 0xB4:
+            if (p->stack_depth > 0) {
+                p->globals = p->stack[--p->stack_depth];
+            }
+            break;
+
+        // Local items. Four byte usages include their page.
+        case 0x08:
+            if (p->num_usages < HID_MAX_USAGES) {
+                p->usages[p->num_usages++] = size == 4 ? uvalue : uvalue & 0xFFFF;
+            }
+            break;
+        case 0x18:
+            p->usage_min = size == 4 ? uvalue : uvalue & 0xFFFF;
+            break;
+        case 0x28:
+            p->usage_max = size == 4 ? uvalue : uvalue & 0xFFFF;
+            break;
+
+        // Main items
+        case 0x80:
+            AddInput(layout, p, uvalue);
+            ClearLocals(p);
+            break;
+        case 0x90:  // Output
+        case 0xB0:  // Feature
+        case 0xA0:  // Collection
+        case 0xC0:  // End collection
+            ClearLocals(p);
+            break;
+        default:
+            break;
+        }
+    }
+
+    ScaleAxes(layout);
+
+    return layout->axes[HID_AXIS_X].size > 0 || layout->buttons.size > 0 ||
+           layout->keys.size > 0;
+}
+
+//
+// Layouts for report maps that can't be read: the boot keyboard report,
+// and the report of an Xbox controller in Bluetooth mode.
+//
+
+void hid_report_keyboard_layout(hid_layout_t *layout) {
+    memset(layout, 0, sizeof(*layout));
+    ResetState();
+
+    layout->any_report = true;
+    layout->modifiers.size = 8;
+    layout->keys.bit_offset = 16;
+    layout->keys.size = 8;
+    layout->key_count = 6;
+}
+
+void hid_report_xbox_layout(hid_layout_t *layout) {
+    static const hid_field_t axes_const[HID_NUM_AXES] = {
+        {0, 16, 0, false, 0, 65535},   // X
+        {16, 16, 0, false, 0, 65535},  // Y
+        {80, 10, 0, false, 0, 1023},   // Right trigger
+        {64, 10, 0, false, 0, 1023},   // Left trigger
+    };
+
+    memset(layout, 0, sizeof(*layout));
+    ResetState();
+
+    layout->any_report = true;
+    memcpy(layout->axes, axes_const, sizeof(axes_const));
+    layout->hat = (hid_field_t){96, 4, 0, false, 1, 8};
+    layout->buttons = (hid_field_t){104, 15, 0, false, 0, 1};
+    ScaleAxes(layout);
+}
+
+//
+// Report decoding
+//
+
+static boolean FieldInReport(const hid_layout_t *layout,
+                             const hid_field_t *field, uint8_t report_id,
+                             size_t len) {
+    return field->size > 0 &&
+           (layout->any_report || field->report_id == report_id) &&
+           (size_t)(field->bit_offset + field->size + 7) / 8 <= len;
+}
+
+// Up to 32 bits from bit_offset, little endian
+static uint32_t GetBits(const uint8_t *data, unsigned int bit_offset,
+                        unsigned int size) {
+    unsigned int first = bit_offset >> 3;
+    unsigned int last = (bit_offset + size - 1) >> 3;
+    uint64_t value = 0;
+
+    for (unsigned int i = last + 1; i > first; i--) {
+        value = (value << 8) | data[i - 1];
+    }
+    value >>= bit_offset & 7;
+
+    return size < 32 ? (uint32_t)value & ((1u << size) - 1) : (uint32_t)value;
+}
+
+static int32_t GetField(const hid_field_t *field, const uint8_t *data) {
+    uint32_t value = GetBits(data, field->bit_offset, field->size);
+
+    if (field->is_signed && field->size < 32 &&
+        (value & (1u << (field->size - 1)))) {
+        value |= ~0u << field->size;
+    }
+
+    return (int32_t)value;
+}
+
+// Axis travel from its centre, or from its rest for triggers, scaled to
+// +-HID_AXIS_FULL
+static int GetAxis(const hid_layout_t *layout, hid_axis_t axis,
+                   const uint8_t *data) {
+    int32_t value = GetField(&layout->axes[axis], data);
+
+    value = ((value - layout->axis_centre[axis]) * layout->axis_scale[axis]) >> 16;
+
+    if (value > HID_AXIS_FULL) {
+        return HID_AXIS_FULL;
+    } else if (value < -HID_AXIS_FULL) {
+        return -HID_AXIS_FULL;
+    }
+    return value;
+}
+
+static int StickValue(int travel) {
+    int magnitude = travel < 0 ? -travel : travel;
+    int index, frac, out;
+
+    if (magnitude <= STICK_DEAD) {
+        return 0;
+    }
+
+    magnitude = ((magnitude - STICK_DEAD) * STICK_STRETCH) >> 16;
+    if (magnitude >= HID_AXIS_FULL) {
+        out = stick_curve_const[16];
+    } else {
+        index = magnitude >> 6;
+        frac = magnitude & 63;
+        out = stick_curve_const[index] +
+              (((stick_curve_const[index + 1] - stick_curve_const[index]) *
+                frac) >> 6);
+    }
+
+    return travel < 0 ? -out : out;
+}
+
+static void PostKey(int key, boolean down, uint32_t timestamp) {
+    event_t event = {0};
+
+    if (key == 0) {
+        return;
+    }
+
+    event.type = down ? ev_keydown : ev_keyup;
+    event.data1 = key;
+    if (down && key >= ' ' && key < 0x7F) {
+        event.data2 = key;
+    }
+    D_PostEventAt(&event, timestamp);
+}
+
+static void DecodeGamepad(const hid_layout_t *layout, uint8_t report_id,
+                          const uint8_t *data, size_t len,
+                          uint32_t timestamp) {
+    // Fields not in this report keep their last values
+    event_t event = prev_joystick_event;
+
+    event.type = ev_joystick;
+
+    if (FieldInReport(layout, &layout->buttons, report_id, len)) {
+        uint32_t buttons = GetBits(data, layout->buttons.bit_offset,
+                                   layout->buttons.size);
+        uint32_t changed = buttons ^ prev_buttons;
+
+        event.data1 = 0;
+        for (int i = 0; i < layout->buttons.size; i++) {
+            const hid_button_t *button = &gamepad_buttons_const[i];
+            boolean down = (buttons >> i) & 1;
+
+            if (down && button->joyb >= 0) {
+                event.data1 |= 1 << button->joyb;
+            }
+            if (((changed >> i) & 1) && button->key != NULL) {
+                PostKey(*button->key, down, timestamp);
+            }
+        }
+        prev_buttons = buttons;
+    }
+
+    if (FieldInReport(layout, &layout->axes[HID_AXIS_X], report_id, len)) {
+        event.data2 = StickValue(GetAxis(layout, HID_AXIS_X, data));
+    }
+    if (FieldInReport(layout, &layout->axes[HID_AXIS_Y], report_id, len)) {
+        event.data3 = StickValue(GetAxis(layout, HID_AXIS_Y, data));
+    }
+
+    // Triggers strafe, the left one taking precedence. Each is only read
+    // when it is in this report, otherwise its last value is kept.
+    boolean brake_in = FieldInReport(layout, &layout->axes[HID_AXIS_BRAKE],
+                                     report_id, len);
+    boolean accel_in = FieldInReport(layout, &layout->axes[HID_AXIS_ACCEL],
+                                     report_id, len);
+
+    if (brake_in || accel_in) {
+        if (brake_in) {
+            prev_brake = GetAxis(layout, HID_AXIS_BRAKE, data);
+        }
+        if (accel_in) {
+            prev_accel = GetAxis(layout, HID_AXIS_ACCEL, data);
+        }
+
+        if (prev_brake > TRIGGER_DEAD) {
+            event.data4 = -(prev_brake >> 2);
+        } else if (prev_accel > TRIGGER_DEAD) {
+            event.data4 = prev_accel >> 2;
+        } else {
+            event.data4 = 0;
+        }
+    }
+
+    // Hat up and down work the menus, diagonals included
+    if (FieldInReport(layout, &layout->hat, report_id, len)) {
+        int direction = GetField(&layout->hat, data) - layout->hat.logical_min;
+        boolean up = direction == 7 || direction == 0 || direction == 1;
+        boolean down = direction >= 3 && direction <= 5;
+
+        if (up != prev_hat_up) {
+            PostKey(key_up, up, timestamp);
+        }
+        if (down != prev_hat_down) {
+            PostKey(key_down, down, timestamp);
+        }
+        prev_hat_up = up;
+        prev_hat_down = down;
+    }
+
+    if (event.data1 != prev_joystick_event.data1 ||
+        event.data2 != prev_joystick_event.data2 ||
+        event.data3 != prev_joystick_event.data3 ||
+        event.data4 != prev_joystick_event.data4) {
+        D_PostEventAt(&event, timestamp);
+        prev_joystick_event = event;
+    }
+}
+
+static boolean KeyIn(const uint8_t *keys, int count, uint8_t key) {
+    for (int i = 0; i < count; i++) {
+        if (keys[i] == key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void DecodeKeyboard(const hid_layout_t *layout, uint8_t report_id,
+                           const uint8_t *data, size_t len,
+                           uint32_t timestamp) {
+    if (FieldInReport(layout, &layout->modifiers, report_id, len)) {
+        uint8_t modifiers = GetBits(data, layout->modifiers.bit_offset, 8);
+        uint8_t changed = modifiers ^ prev_modifiers;
+
+        for (int i = 0; changed != 0; i++, changed >>= 1) {
+            if (changed & 1) {
+                PostKey(hid_modifiers_const[i], (modifiers >> i) & 1,
+                        timestamp);
+            }
+        }
+        prev_modifiers = modifiers;
+    }
+
+    if (FieldInReport(layout, &layout->keys, report_id, len)) {
+        const hid_field_t *field = &layout->keys;
+        int count = layout->key_count;
+        uint8_t keys[HID_MAX_USAGES];
+
+        if ((size_t)(field->bit_offset + field->size * count + 7) / 8 > len) {
+            count = (len * 8 - field->bit_offset) / field->size;
+        }
+
+        for (int i = 0; i < count; i++) {
+            keys[i] = GetBits(data, field->bit_offset + i * field->size,
+                              field->size);
+        }
+        for (int i = count; i < layout->key_count; i++) {
+            keys[i] = 0;
+        }
+
+        // Usages 0 to 3 are no key and error codes
+        for (int i = 0; i < layout->key_count; i++) {
+            if (keys[i] > 3 && !KeyIn(prev_keys, layout->key_count, keys[i])) {
+                PostKey(hid_keys_const[keys[i]], true, timestamp);
+            }
+        }
+        for (int i = 0; i < layout->key_count; i++) {
+            if (prev_keys[i] > 3 && !KeyIn(keys, layout->key_count, prev_keys[i])) {
+                PostKey(hid_keys_const[prev_keys[i]], false, timestamp);
+            }
+        }
+
+        memcpy(prev_keys, keys, layout->key_count);
+    }
+}
+
+void hid_report_decode(const hid_layout_t *layout, uint8_t report_id,
+                       const uint8_t *data, size_t len, uint32_t timestamp) {
+    if (layout->buttons.size > 0 || layout->axes[HID_AXIS_X].size > 0 ||
+        layout->hat.size > 0) {
+        DecodeGamepad(layout, report_id, data, len, timestamp);
+    }
+    if (layout->keys.size > 0 || layout->modifiers.size > 0) {
+        DecodeKeyboard(layout, report_id, data, len, timestamp);
+    }
+}
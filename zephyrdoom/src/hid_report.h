@@ -0,0 +1,93 @@
+//
+// Copyright(C) 2021 Nordic Semiconductor ASA
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      HID input report decoding.
+//
+
+#ifndef HID_REPORT_H__
+#define HID_REPORT_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "doomtype.h"
+
+// Decoding of HID input reports into Doom events, driven by the report
+// map the device sends. The map is parsed once when a device connects;
+// each report is then decoded with a few shifts and table lookups.
+
+#define HID_GAMEPAD_BUTTONS 16
+
+// Full stick or trigger travel, after scaling
+#define HID_AXIS_FULL 1024
+
+// Stick dead zone, in percent of full travel
+#ifndef HID_STICK_DEAD_ZONE
+#define HID_STICK_DEAD_ZONE 12
+#endif
+
+// Trigger travel, in percent, before it counts as pressed
+#ifndef HID_TRIGGER_DEAD_ZONE
+#define HID_TRIGGER_DEAD_ZONE 2
+#endif
+
+// A value at bit_offset in reports with report_id. size is 0 if the
+// device has no such field.
+typedef struct {
+    uint16_t bit_offset;
+    uint8_t size;
+    uint8_t report_id;
+    boolean is_signed;
+    int32_t logical_min;
+    int32_t logical_max;
+} hid_field_t;
+
+typedef enum {
+    HID_AXIS_X,
+    HID_AXIS_Y,
+    HID_AXIS_ACCEL,  // Right trigger
+    HID_AXIS_BRAKE,  // Left trigger
+    HID_NUM_AXES,
+} hid_axis_t;
+
+typedef struct {
+    // Gamepad
+    hid_field_t axes[HID_NUM_AXES];
+    int32_t axis_centre[HID_NUM_AXES];
+    int32_t axis_scale[HID_NUM_AXES];  // 16.16, to +-HID_AXIS_FULL
+    hid_field_t hat;
+    hid_field_t buttons;  // One bit per button, size is the count
+
+    // Keyboard
+    hid_field_t modifiers;  // One bit per modifier key
+    hid_field_t keys;       // Array of usages, size is one entry
+    uint8_t key_count;
+
+    boolean any_report;  // Fields are in every report, whatever its ID
+} hid_layout_t;
+
+// Build a layout from a HID report map. Returns false if the map has
+// neither gamepad nor keyboard fields.
+boolean hid_report_parse_map(const uint8_t *map, size_t len,
+                             hid_layout_t *layout);
+
+// Layouts for devices whose report map can't be read
+void hid_report_keyboard_layout(hid_layout_t *layout);
+void hid_report_xbox_layout(hid_layout_t *layout);
+
+// Post the events for one input report, captured at timestamp
+void hid_report_decode(const hid_layout_t *layout, uint8_t report_id,
+                       const uint8_t *data, size_t len, uint32_t timestamp);
+
+#endif
@@ -21,6 +21,7 @@
 #include "doomtype.h"
 
 #include "i_sound.h"
+#include "m_argv.h"
 
 // Whether to vary the pitch of sound effects
 // Each game will set the default differently
@@ -35,6 +36,7 @@ static music_module_t *music_module;
 int snd_musicdevice = SNDDEVICE_SB;
 
 extern sound_module_t sound_i2s_module;
+extern music_module_t music_i2s_module;
 
 // DOS-specific options: These are unused but should be maintained
 // so that the config file can be shared between chocolate
@@ -55,9 +57,7 @@ static sound_module_t *sound_modules[] = {
 // Compiled-in music modules:
 
 static music_module_t *music_modules[] = {
-    // NRFD-TODO?
-    //&music_sdl_module,
-    //&music_opl_module,
+    &music_i2s_module,
     NULL,
 };
 
@@ -146,8 +146,7 @@ void I_InitSound(boolean use_sfx_prefix) {
     // Disable music.
     //
 
-    // NRFD-TODO: Music
-    nomusic = true;  // M_CheckParm("-nomusic") > 0;
+    nomusic = M_CheckParm("-nomusic") > 0;
 
     // Initialize the sound and music subsystems.
 
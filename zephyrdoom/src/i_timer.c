@@ -56,6 +56,13 @@ uint32_t I_RawTimeToFps(uint32_t time_delta)
     return 31200/time_delta;
 }
 
+// 31.25 kHz timer, 32 us per count
+
+uint32_t I_RawTimeToUS(uint32_t time_delta)
+{
+    return time_delta * 32;
+}
+
 uint32_t I_GetTimeRaw(void)
 {
     NRF_DOOM_TIMER->TASKS_CAPTURE[0] = 1;
@@ -33,6 +33,7 @@ int I_GetTimeMS (void);
 uint32_t I_GetTimeRaw (void);
 
 uint32_t I_RawTimeToFps(uint32_t time_delta);
+uint32_t I_RawTimeToUS(uint32_t time_delta);
 
 // Pause for a specified number of ms
 void I_Sleep(int ms);
@@ -31,7 +31,9 @@
 #include "i_timer.h"
 #include "i_video.h"
 #include "m_argv.h"
+#include "m_bbox.h"
 #include "m_config.h"
+#include "m_latency.h"
 #include "m_misc.h"
 #include "tables.h"
 #include "v_diskicon.h"
@@ -40,13 +42,9 @@
 #include "z_zone.h"
 
 #include "n_buttons.h"
-#include "n_display.h"
+#include "n_display_backend.h"
 #include "n_rjoy.h"
 
-#include "FT810.h"
-
-static uint32_t pixel_format;
-
 
 // display has been set up?
 
@@ -123,15 +121,34 @@ const int usemouse = 1;
 
 pixel_t *I_VideoBuffer; //[320*200];
 pixel_t *I_VideoBackBuffer; //[320*200];
-pixel_t I_VideoBuffers[2][320*200];
+// Word aligned for the RGB565 converter
+pixel_t I_VideoBuffers[2][320*200] __attribute__((aligned(4)));
+
+pixel_t I_StatusBarBuffer[SCREENWIDTH*STATUSBARHEIGHT];
+pixel_t *const I_StatusBarScreen =
+    I_StatusBarBuffer - (SCREENHEIGHT-STATUSBARHEIGHT)*SCREENWIDTH;
+
+// The display backend in use
+static const n_display_backend_t *display = &N_display_ft810;
 
-uint8_t  display_pal[DISPLAY_PALETTE_SIZE];
+// Status bar layer in use this frame, and changed since it was last sent?
+static boolean statusbar_layer;
+static boolean statusbar_dirty = true;
 
-static int current_dl;
+// Size of the scaled view, 0 when the view is drawn into the frame.
+// The scaled view is kept packed at the end of I_VideoBuffer.
+static int scaledview_width;
+static int scaledview_height;
 
-// Memory references for display driver memory
-static uint32_t display_vbuffer_locs[3]; // Frame buffer
-static uint32_t display_palette_locs[3]; // Pallette
+// Scaled view shown this frame, and already sent?
+static boolean scaledview;
+static boolean scaledview_sent;
+
+// Automap drawn as lines this frame?
+static boolean maplines;
+
+// Palette index left transparent where something is drawn over the view
+#define OVERLAY_TRANSPARENT 251
 
 // If true, game is running as a screensaver
 
@@ -183,6 +200,7 @@ void I_ShutdownGraphics(void)
 {
     if (initialized)
     {
+        display->wait_idle();
         initialized = false;
     }
 }
@@ -245,58 +263,6 @@ void I_UpdateNoBlit (void)
     // what is this?
 }
 
-void I_WriteDisplayList(uint32_t pal_loc, uint32_t display_loc)
-{
-    dl_start();
-
-    dl(FT810_CLEAR_COLOR_RGB(0x00, 0x00, 0x00));
-    dl(FT810_CLEAR(1,1,1));  // Clear color, stencil, tag
-    dl(FT810_CLEAR_COLOR_RGB(0x00, 0x00, 0x00));
-    dl(FT810_CLEAR(1,0,0));  // Clear color
-
-    dl(FT810_BITMAP_HANDLE(0)) ;
-    dl(FT810_BITMAP_LAYOUT(PALETTED8, SCREENWIDTH, SCREENHEIGHT)) ;
-    int16_t trans_a = (int16_t)(256/2.0);
-    int16_t trans_b = (int16_t)(256/2.4);
-    dl(FT810_BITMAP_TRANSFORM_A(trans_a));
-    dl(FT810_BITMAP_TRANSFORM_E(trans_b));
-    dl(FT810_BITMAP_SIZE(NEAREST, BORDER, BORDER, 640&0x1FF, 480));
-    dl(FT810_BITMAP_SIZE_H(640>>9, 0));
-    dl(FT810_BITMAP_SOURCE(display_loc)) ;
-
-    dl(FT810_COLOR_RGB(0xFF, 0xFF, 0xFF));
-
-    dl(FT810_BEGIN(BITMAPS));
-    {
-        dl(FT810_VERTEX_TRANSLATE_X(80*16));
-        // dl(FT810_VERTEX_TRANSLATE_Y(0*16));
-
-        dl(FT810_BLEND_FUNC(ONE, ZERO));
-
-        dl(FT810_COLOR_MASK(0,0,0,1));
-        dl(FT810_PALETTE_SOURCE(pal_loc+3));
-        dl(FT810_VERTEX2II(0, 0, 0, 0));
-
-        dl(FT810_BLEND_FUNC(DST_ALPHA, ONE_MINUS_DST_ALPHA));
-        dl(FT810_COLOR_MASK(1,0,0,0));
-        dl(FT810_PALETTE_SOURCE(pal_loc));
-        dl(FT810_VERTEX2II(0, 0, 0, 0));
-
-        dl(FT810_COLOR_MASK(0,1,0,0));
-        dl(FT810_PALETTE_SOURCE(pal_loc+1));
-        dl(FT810_VERTEX2II(0, 0, 0, 0));
-
-        dl(FT810_COLOR_MASK(0,0,1,0));
-        dl(FT810_PALETTE_SOURCE(pal_loc+2));
-        dl(FT810_VERTEX2II(0, 0, 0, 0));
-    }
-    dl(FT810_END());
-
-    dl_end();
-
-    N_display_dlswap_frame();
-}
-
 //
 // I_FinishUpdate
 //
@@ -305,6 +271,7 @@ void I_FinishUpdate (void)
     static int lasttic;
     int tics;
     int i;
+    n_display_frame_t frame;
 
     // draws little dots on the bottom of the screen
     if (display_fps_dots)
@@ -323,20 +290,53 @@ void I_FinishUpdate (void)
     // Draw disk icon before blit, if necessary.
     // NRFD_TODO: V_DrawDiskIcon();
 
-    // Wait for previous frame buffer transfer to finish
-    N_display_spi_transfer_finish();
+    memset(&frame, 0, sizeof(frame));
+    frame.buffer = I_VideoBuffer;
+    frame.rows = SCREENHEIGHT;
 
-    // Instruct display to start drawing previous frame
-    I_WriteDisplayList(display_palette_locs[current_dl], display_vbuffer_locs[current_dl]);
+    if (statusbar_layer)
+    {
+        frame.rows = SCREENHEIGHT - STATUSBARHEIGHT;
+        if (statusbar_dirty)
+        {
+            frame.statusbar = I_StatusBarBuffer;
+            statusbar_dirty = false;
+        }
+    }
 
-    current_dl = (current_dl+1)%3;
+    if (scaledview || maplines)
+    {
+        int top = dirtybox[BOXBOTTOM];
+        int bottom = dirtybox[BOXTOP] + 1;
+        int limit = frame.rows;
 
-    // Do complete palette data transfer
-    N_display_spi_wr(display_palette_locs[current_dl], DISPLAY_PALETTE_SIZE, display_pal);
-    N_display_spi_transfer_finish();
+        // Only the rows drawn into are sent, and they can't reach into
+        // the view unless it has been sent already.
+        if (scaledview && !scaledview_sent)
+        {
+            limit = (SCREENWIDTH*SCREENHEIGHT
+                     - scaledview_width*scaledview_height) / SCREENWIDTH;
+            if (limit > frame.rows)
+                limit = frame.rows;
+        }
+        if (top < 0)
+            top = 0;
+        if (bottom > limit)
+            bottom = limit;
+
+        frame.overlay_top = top;
+        frame.overlay_rows = bottom > top ? bottom - top : 0;
+        frame.map = maplines;
+        if (scaledview)
+        {
+            frame.view_width = scaledview_width;
+            frame.view_height = scaledview_height;
+            frame.view_sent = scaledview_sent;
+        }
+    }
 
-    // Start frame buffer transfer
-    N_display_spi_wr(display_vbuffer_locs[current_dl], SCREENWIDTH*SCREENHEIGHT, (uint8_t*)I_VideoBuffer);
+    display->submit_frame(&frame);
+    M_LatencyStage(LAT_SWAP);
 
     // Restore background and undo the disk indicator, if it was drawn.
     // NRFD-TODO: V_RestoreDiskBackground();
@@ -349,6 +349,13 @@ void I_FinishUpdate (void)
 void I_ReadScreen (pixel_t* scr)
 {
     memcpy(scr, I_VideoBuffer, SCREENWIDTH*SCREENHEIGHT*sizeof(*scr));
+
+    // The bottom of I_VideoBuffer isn't drawn when the layer is in use
+    if (statusbar_layer)
+    {
+        memcpy(scr + SCREENWIDTH*(SCREENHEIGHT-STATUSBARHEIGHT),
+               I_StatusBarBuffer, sizeof(I_StatusBarBuffer));
+    }
 }
 
 
@@ -357,26 +364,19 @@ void I_ReadScreen (pixel_t* scr)
 //
 void I_SetPalette (byte *doompalette)
 {
+    byte palette[256*3];
     int i;
     // printf("I_SetPalette %X\n", (unsigned int)(doompalette));
 
-    // Convert Doom palette to FT810 palette
-
-    // TODO: Do conversion right before transferring to save memory?
-    for (i=0; i<256; ++i)
+    for (i=0; i<256*3; ++i)
     {
         // Zero out the bottom two bits of each channel - the PC VGA
         // controller only supports 6 bits of accuracy.
 
-        uint8_t r = gammatable[usegamma][*doompalette++] & ~3;
-        uint8_t g = gammatable[usegamma][*doompalette++] & ~3;
-        uint8_t b = gammatable[usegamma][*doompalette++] & ~3;
-        display_pal[i*4+0] = r;
-        display_pal[i*4+1] = g;
-        display_pal[i*4+2] = b;
-        display_pal[i*4+3] = 0xFF;
-
+        palette[i] = gammatable[usegamma][*doompalette++] & ~3;
     }
+
+    display->set_palette(palette);
 }
 
 /* NRFD-EXCLUDE
@@ -451,6 +451,29 @@ void I_GraphicsCheckCommandLine(void)
     //
     // NRFD-EXCLUDE
     // nomouse = M_CheckParm("-nomouse") > 0;
+
+    //!
+    // @category video
+    //
+    // Draw frames without sending them to the display, to measure
+    // drawing speed with -timedemo.
+    //
+
+    if (M_CheckParm("-nodisplay") > 0)
+    {
+        display = &N_display_null;
+    }
+
+    //!
+    // @category video
+    //
+    // Send frames as RGB565, the way panels without a palette take them.
+    //
+
+    if (M_CheckParm("-rgb565") > 0)
+    {
+        display = &N_display_rgb565;
+    }
 }
 
 
@@ -458,18 +481,7 @@ void I_GraphicsCheckCommandLine(void)
 void I_InitGraphics(void)
 {
     printf("I_InitGraphics\n");
-    N_display_init();
-    display_palette_locs[0] = N_display_ram_alloc(DISPLAY_PALETTE_SIZE);
-    display_palette_locs[1] = N_display_ram_alloc(DISPLAY_PALETTE_SIZE);
-    display_palette_locs[2] = N_display_ram_alloc(DISPLAY_PALETTE_SIZE);
-    display_vbuffer_locs[0] = N_display_ram_alloc(SCREENWIDTH*SCREENHEIGHT);
-    display_vbuffer_locs[1] = N_display_ram_alloc(SCREENWIDTH*SCREENHEIGHT);
-    display_vbuffer_locs[2] = N_display_ram_alloc(SCREENWIDTH*SCREENHEIGHT);
-
-    current_dl = 1;
-
-    // I_WriteDisplayList(display_palette_locs[0], display_vbuffer_locs[0]);
-    // I_WriteDisplayList(display_palette_locs[1], display_vbuffer_locs[1]);
+    display->init();
 
     I_VideoBuffer = I_VideoBuffers[1];
     I_VideoBackBuffer = I_VideoBuffers[0];
@@ -516,8 +528,103 @@ void I_ClearVideoBuffer(void)
         I_VideoBackBuffer = I_VideoBuffers[1];
     }
     V_RestoreBuffer();
+    M_ClearBox(dirtybox);
+    scaledview = false;
+    scaledview_sent = false;
+    maplines = false;
 
     // for (int i=0; i<SCREENHEIGHT*SCREENWIDTH; i++) {
     //     I_VideoBuffer[i] = 251; // pink
     // }
 }
+
+void I_EnableStatusBarLayer(boolean enable)
+{
+    statusbar_layer = enable && (display->caps & N_DISPLAY_CAP_LAYERS) != 0;
+}
+
+boolean I_StatusBarLayerEnabled(void)
+{
+    return statusbar_layer;
+}
+
+void I_MarkStatusBarDirty(void)
+{
+    statusbar_dirty = true;
+}
+
+boolean I_SetScaledView(int width, int height)
+{
+    if (!(display->caps & N_DISPLAY_CAP_SCALE))
+    {
+        width = height = 0;
+    }
+
+    scaledview_width = width;
+    scaledview_height = height;
+
+    return width != 0;
+}
+
+void I_EnableScaledView(boolean enable)
+{
+    scaledview = enable && scaledview_width != 0;
+
+    // Everything drawn above the view is shown over it
+    if (scaledview)
+    {
+        memset(I_VideoBuffer, OVERLAY_TRANSPARENT,
+               SCREENWIDTH*SCREENHEIGHT - scaledview_width*scaledview_height);
+    }
+}
+
+void I_FlushScaledView(void)
+{
+    if (!scaledview || scaledview_sent)
+    {
+        return;
+    }
+
+    display->send_view(I_VideoBuffer + SCREENWIDTH*SCREENHEIGHT
+                           - scaledview_width*scaledview_height,
+                       scaledview_width, scaledview_height);
+    scaledview_sent = true;
+
+    memset(I_VideoBuffer + SCREENWIDTH*SCREENHEIGHT
+               - scaledview_width*scaledview_height,
+           OVERLAY_TRANSPARENT, scaledview_width*scaledview_height);
+}
+
+boolean I_StartMapLines(int background)
+{
+    if (!(display->caps & N_DISPLAY_CAP_LINES))
+    {
+        return false;
+    }
+
+    maplines = true;
+
+    // Everything drawn into I_VideoBuffer is shown over the lines
+    memset(I_VideoBuffer, OVERLAY_TRANSPARENT, SCREENWIDTH*SCREENHEIGHT);
+
+    display->start_map(background);
+    return true;
+}
+
+boolean I_AddMapLine(int x0, int y0, int x1, int y1, int color)
+{
+    return display->add_map_line(x0, y0, x1, y1, color);
+}
+
+void I_CancelMapLines(void)
+{
+    maplines = false;
+}
+
+void I_StopMapLines(void)
+{
+    if (display->caps & N_DISPLAY_CAP_LINES)
+    {
+        display->end_map();
+    }
+}
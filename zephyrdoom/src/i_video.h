@@ -31,6 +31,10 @@
 
 #define SCREENHEIGHT_4_3 240
 
+// Height of the status bar layer at the bottom of the screen.
+
+#define STATUSBARHEIGHT 32
+
 // extern char *video_driver;
 extern const boolean screenvisible;
 
@@ -41,6 +45,13 @@ extern pixel_t *I_VideoBuffer;
 extern pixel_t *I_VideoBackBuffer;
 extern pixel_t I_VideoBuffers[2][320*200];
 
+// The status bar layer. It persists between frames and is only sent to
+// the display when something has been drawn into it.
+// I_StatusBarScreen addresses it with full screen coordinates, so it can
+// be passed to V_UseBuffer.
+extern pixel_t I_StatusBarBuffer[SCREENWIDTH*STATUSBARHEIGHT];
+extern pixel_t *const I_StatusBarScreen;
+
 // extern int screen_width;
 // extern int screen_height;
 // extern int fullscreen;
@@ -96,4 +107,46 @@ void I_EnableLoadingDisk(int xoffs, int yoffs);
 
 void I_ClearVideoBuffer(void);
 
+// Composite the status bar layer on the display instead of sending the
+// bottom of I_VideoBuffer. Decided per frame, before the status bar is drawn.
+
+void I_EnableStatusBarLayer(boolean enable);
+boolean I_StatusBarLayerEnabled(void);
+void I_MarkStatusBarDirty(void);
+
+// Size of a view drawn packed at the end of I_VideoBuffer and scaled up
+// by the display, or 0 when the view is drawn into the frame.
+// Returns false when the display can't scale.
+boolean I_SetScaledView(int width, int height);
+
+// Build with VIEW_UPLOAD_TRANSPOSED=1 to store and upload the scaled view
+// a column per line, and have the display swap the axes when it draws it.
+// This only changes the orientation of the buffer sent to the display.
+// The usual drawers write into it through their strides, there are no
+// drawers or patch routines written for the transposed layout, and
+// everything outside the scaled view stays row-major.
+#ifndef VIEW_UPLOAD_TRANSPOSED
+#define VIEW_UPLOAD_TRANSPOSED 0
+#endif
+
+// Show the scaled view this frame, with anything drawn into the rest of
+// I_VideoBuffer over it. Decided per frame, before drawing.
+void I_EnableScaledView(boolean enable);
+
+// Send the scaled view early, so all of I_VideoBuffer can be drawn over.
+void I_FlushScaledView(void);
+
+// Let the display draw the automap as lines this frame, over a background
+// of the given colour, if it can. Anything drawn into I_VideoBuffer is
+// shown over it.
+// Coordinates are in 1/16 pixels of the automap frame. I_AddMapLine
+// returns false when the lines don't fit, and the automap has to be drawn
+// into I_VideoBuffer after all, following I_CancelMapLines.
+boolean I_StartMapLines(int background);
+boolean I_AddMapLine(int x0, int y0, int x1, int y1, int color);
+void I_CancelMapLines(void);
+
+// The automap closed, the display can free what it drew the lines with.
+void I_StopMapLines(void);
+
 #endif
@@ -0,0 +1,172 @@
+//
+// Copyright(C) 2021 Nordic Semiconductor ASA
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Input latency tracing.
+//
+//      Only depends on the raw timer and the event queue counts, so it
+//      can be built on a host and driven by a scripted input sequence,
+//      see m_latency_host.c.
+//
+
+#include <stdio.h>
+#include <string.h>
+
+#include "d_event.h"
+#include "i_timer.h"
+#include "m_latency.h"
+
+#if LATENCY_TRACE
+
+static const char *const stage_names_const[NUM_LAT_STAGES] =
+{
+    "event", "ticcmd", "tic", "render", "swap",
+};
+
+static lathist_t histograms[NUM_LAT_STAGES];
+
+// The input being followed. Stages are only recorded in order, so inputs
+// arriving while one is in flight are not traced.
+static boolean trace_active;
+static latstage_t trace_stage;
+static uint32_t trace_start;
+static int trace_tic;
+static unsigned int traces_done;
+
+static void RecordStage(latstage_t stage)
+{
+    lathist_t *hist = &histograms[stage];
+    unsigned int us = I_RawTimeToUS(I_GetTimeRaw() - trace_start);
+    unsigned int bucket = us / (LATENCY_BUCKET_MS * 1000);
+
+    if (bucket >= LATENCY_BUCKETS)
+    {
+        bucket = LATENCY_BUCKETS - 1;
+    }
+
+    hist->count++;
+    hist->total_us += us;
+    hist->buckets[bucket]++;
+    if (us > hist->max_us)
+    {
+        hist->max_us = us;
+    }
+
+    trace_stage = stage;
+}
+
+//
+// M_LatencyEvent
+// An event posted at timestamp (raw timer time) was handled
+//
+void M_LatencyEvent(uint32_t timestamp)
+{
+    if (trace_active)
+    {
+        return;
+    }
+
+    trace_active = true;
+    trace_start = timestamp;
+    RecordStage(LAT_EVENT);
+}
+
+void M_LatencyTiccmd(int maketic)
+{
+    if (trace_active && trace_stage == LAT_EVENT)
+    {
+        trace_tic = maketic;
+        RecordStage(LAT_TICCMD);
+    }
+}
+
+void M_LatencyTic(int tic)
+{
+    if (trace_active && trace_stage == LAT_TICCMD && tic >= trace_tic)
+    {
+        RecordStage(LAT_TIC);
+    }
+}
+
+//
+// M_LatencyStage
+// For the display stages, which follow the tic
+//
+void M_LatencyStage(latstage_t stage)
+{
+    if (!trace_active || stage != trace_stage + 1 || stage <= LAT_TIC)
+    {
+        return;
+    }
+
+    RecordStage(stage);
+
+    if (stage == NUM_LAT_STAGES - 1)
+    {
+        trace_active = false;
+        traces_done++;
+
+#if LATENCY_REPORT_TRACES
+        if (traces_done % LATENCY_REPORT_TRACES == 0)
+        {
+            M_LatencyReport();
+        }
+#endif
+    }
+}
+
+const lathist_t *M_LatencyHistogram(latstage_t stage)
+{
+    return &histograms[stage];
+}
+
+//
+// M_LatencyReport
+// One line per stage: average and maximum in ms, then the number of
+// inputs in each LATENCY_BUCKET_MS bucket.
+//
+void M_LatencyReport(void)
+{
+    unsigned int posted, dropped;
+    int i, j;
+
+    D_GetEventStats(&posted, &dropped);
+    printf("Latency from input, %d ms buckets, %u events, %u dropped:\n",
+           LATENCY_BUCKET_MS, posted, dropped);
+
+    for (i = 0; i < NUM_LAT_STAGES; i++)
+    {
+        const lathist_t *hist = &histograms[i];
+        unsigned int avg = hist->count ? hist->total_us / hist->count : 0;
+
+        printf("%7s: avg %u.%u max %u.%u |", stage_names_const[i],
+               avg / 1000, avg % 1000 / 100,
+               hist->max_us / 1000, hist->max_us % 1000 / 100);
+
+        for (j = 0; j < LATENCY_BUCKETS; j++)
+        {
+            printf(" %u", hist->buckets[j]);
+        }
+
+        printf("\n");
+    }
+}
+
+void M_LatencyReset(void)
+{
+    memset(histograms, 0, sizeof(histograms));
+    trace_active = false;
+    traces_done = 0;
+}
+
+#endif
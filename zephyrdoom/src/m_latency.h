@@ -0,0 +1,84 @@
+//
+// Copyright(C) 2021 Nordic Semiconductor ASA
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Input latency tracing.
+//
+//      One input at a time is followed from capture, through the
+//      ticcmd it ends up in and the tic that runs it, to the first
+//      frame drawn and swapped after that tic. The time from capture
+//      to each stage is collected in histograms and logged.
+//
+
+
+#ifndef __M_LATENCY__
+#define __M_LATENCY__
+
+#include "doomtype.h"
+
+// Build with LATENCY_TRACE=1 to trace. The hooks compile to nothing
+// otherwise.
+#ifndef LATENCY_TRACE
+#define LATENCY_TRACE 0
+#endif
+
+// Width of a histogram bucket
+#define LATENCY_BUCKET_MS 8
+#define LATENCY_BUCKETS 16
+
+// Log the histograms after this many inputs have been followed to the
+// screen, 0 to never
+#ifndef LATENCY_REPORT_TRACES
+#define LATENCY_REPORT_TRACES 100
+#endif
+
+typedef enum
+{
+    LAT_EVENT,          // Popped by D_ProcessEvents
+    LAT_TICCMD,         // Built into a ticcmd
+    LAT_TIC,            // The ticcmd's tic was run
+    LAT_RENDER,         // A frame after that tic was drawn
+    LAT_SWAP,           // That frame was handed to the display
+    NUM_LAT_STAGES
+} latstage_t;
+
+typedef struct
+{
+    unsigned int count;
+    unsigned int max_us;
+    uint64_t total_us;
+    // The last bucket also holds everything slower
+    unsigned int buckets[LATENCY_BUCKETS];
+} lathist_t;
+
+#if LATENCY_TRACE
+
+void M_LatencyEvent(uint32_t timestamp);
+void M_LatencyTiccmd(int maketic);
+void M_LatencyTic(int tic);
+void M_LatencyStage(latstage_t stage);
+
+const lathist_t *M_LatencyHistogram(latstage_t stage);
+void M_LatencyReport(void);
+void M_LatencyReset(void);
+
+#else
+
+#define M_LatencyEvent(timestamp)
+#define M_LatencyTiccmd(maketic)
+#define M_LatencyTic(tic)
+#define M_LatencyStage(stage)
+
+#endif
+
+#endif
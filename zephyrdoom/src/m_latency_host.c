@@ -0,0 +1,150 @@
+//
+// Copyright(C) 2021 Nordic Semiconductor ASA
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Host driver for the latency tracing in m_latency.c. Not part of
+//      the firmware. Reads an input script and runs it through the
+//      latency hooks with a simulated game loop, then prints the
+//      histograms.
+//
+//      Build and run from this directory:
+//
+//          cc -DLATENCY_TRACE=1 -I. -Iconfig m_latency_host.c m_latency.c
+//          ./a.out < script.txt
+//
+//      Each script line is the time in ms an input was captured, in
+//      increasing order. Lines starting with # are ignored. The loop
+//      runs a tic every 1000/TICRATE ms, and the tic, render and swap
+//      take the times set below.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "d_event.h"
+#include "i_timer.h"
+#include "m_latency.h"
+
+#if !LATENCY_TRACE
+#error Build with -DLATENCY_TRACE=1
+#endif
+
+// Simulated time taken by each stage of a tic
+#define HOST_TIC_US     2000
+#define HOST_RENDER_US  15000
+#define HOST_SWAP_US    3000
+
+#define HOST_MAX_INPUTS 1024
+
+// Raw timer units, as on the board
+#define RAW_US          32
+
+static uint32_t now;
+static unsigned int inputs_posted;
+
+uint32_t I_GetTimeRaw(void)
+{
+    return now;
+}
+
+uint32_t I_RawTimeToUS(uint32_t time_delta)
+{
+    return time_delta * RAW_US;
+}
+
+void D_GetEventStats(unsigned int *posted, unsigned int *dropped)
+{
+    *posted = inputs_posted;
+    *dropped = 0;
+}
+
+static int ReadScript(FILE *f, int *times, int max)
+{
+    char line[64];
+    int count = 0;
+
+    while (count < max && fgets(line, sizeof(line), f) != NULL)
+    {
+        if (line[0] == '#' || line[0] == '\n')
+        {
+            continue;
+        }
+
+        times[count++] = atoi(line);
+    }
+
+    return count;
+}
+
+int main(void)
+{
+    static int times[HOST_MAX_INPUTS];
+    int count;
+    int next = 0;
+    int maketic = 0;
+    int gametic = 0;
+    int tic_ms;
+    int ms;
+    int pending = -1;
+
+    count = ReadScript(stdin, times, HOST_MAX_INPUTS);
+    if (count == 0)
+    {
+        fprintf(stderr, "No inputs in script\n");
+        return 1;
+    }
+
+    // Run until the last input has had time to reach the screen
+    tic_ms = 0;
+    for (ms = 0; ms <= times[count - 1] + 1000; ms++)
+    {
+        now = ms * 1000 / RAW_US;
+
+        // Only the first input of a tic is traced, like on the board
+        while (next < count && times[next] <= ms)
+        {
+            if (pending < 0)
+            {
+                pending = times[next] * 1000 / RAW_US;
+            }
+            inputs_posted++;
+            next++;
+        }
+
+        if (ms < tic_ms)
+        {
+            continue;
+        }
+        tic_ms = (maketic + 1) * 1000 / TICRATE;
+
+        if (pending >= 0)
+        {
+            M_LatencyEvent(pending);
+            pending = -1;
+        }
+        M_LatencyTiccmd(maketic++);
+
+        now += HOST_TIC_US / RAW_US;
+        M_LatencyTic(gametic++);
+
+        now += HOST_RENDER_US / RAW_US;
+        M_LatencyStage(LAT_RENDER);
+
+        now += HOST_SWAP_US / RAW_US;
+        M_LatencyStage(LAT_SWAP);
+    }
+
+    M_LatencyReport();
+
+    return 0;
+}
@@ -41,6 +41,7 @@
 #include "doomkeys.h"
 #include "d_event.h"
 #include "i_system.h"
+#include "i_timer.h"
 
 boolean button_prev_state[4];
 
@@ -81,6 +82,7 @@ void N_ReadButtons()
     boolean button_state[4];
     boolean button_posedge[4];
     boolean button_negedge[4];
+    uint32_t timestamp = I_GetTimeRaw();
     for (int i=0; i<4; i++) {
         button_state[i] = N_ButtonStateRaw(i);
         button_posedge[i] = button_state[i] && !button_prev_state[i];
@@ -93,14 +95,14 @@ void N_ReadButtons()
             event.data1 = button_map[i];
             event.data2 = 0;
             event.data3 = 0;
-            D_PostEvent(&event);
+            D_PostEventAt(&event, timestamp);
         }
         else if (button_negedge[i]) {
             event.type = ev_keyup;
             event.data1 = button_map[i];
             event.data2 = 0;
             event.data3 = 0;
-            D_PostEvent(&event);
+            D_PostEventAt(&event, timestamp);
         }
     }
 
@@ -342,6 +342,11 @@ void dl(uint32_t cmd) {
   N_display_spi_wr32(display_dli, cmd);
   display_dli += 4;
 }
+// Write a block of commands in one transfer
+void dl_block(const uint32_t *cmds, int count) {
+  N_display_spi_wr(display_dli, count*4, (uint8_t*)cmds);
+  display_dli += count*4;
+}
 void dl_end() {
   N_display_spi_wr32(display_dli, FT810_DISPLAY());
 }
@@ -52,4 +52,5 @@ uint32_t N_display_ram_alloc(size_t size);
 void N_display_dlswap_frame();
 void dl_start();
 void dl(uint32_t cmd);
+void dl_block(const uint32_t *cmds, int count);
 void dl_end();
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2019 - 2020, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+// Display backends. i_video.c draws frames into memory and hands them to
+// one of these, which owns the display hardware.
+
+#ifndef __N_DISPLAY_BACKEND__
+#define __N_DISPLAY_BACKEND__
+
+#include "doomtype.h"
+
+// The backend can show the status bar layer and overlays
+#define N_DISPLAY_CAP_LAYERS  0x01
+// The backend can scale up a view smaller than the frame
+#define N_DISPLAY_CAP_SCALE   0x02
+// The backend can draw the automap as lines
+#define N_DISPLAY_CAP_LINES   0x04
+
+// A frame to show, see i_video.h
+typedef struct
+{
+    const pixel_t *buffer;      // SCREENWIDTH*SCREENHEIGHT frame buffer
+    int rows;                   // Rows above the status bar layer
+
+    // Status bar layer, when rows < SCREENHEIGHT. Only set when it has
+    // changed since it was last submitted.
+    const pixel_t *statusbar;
+
+    // Scaled view packed at the end of the buffer, or 0 when not shown.
+    // It may have been sent already, with send_view.
+    int view_width;
+    int view_height;
+    boolean view_sent;
+
+    // Automap lines given with add_map_line shown
+    boolean map;
+
+    // Rows of the buffer shown over a scaled view or the automap lines
+    int overlay_top;
+    int overlay_rows;
+} n_display_frame_t;
+
+typedef struct
+{
+    const char *name;
+    int caps;                   // N_DISPLAY_CAP_*
+
+    void (*init)(void);
+
+    // 256 RGB triplets, gamma corrected
+    void (*set_palette)(const byte *palette);
+
+    // May return before the frame has been sent, the buffer must be left
+    // alone until wait_idle or the next submit_frame.
+    void (*submit_frame)(const n_display_frame_t *frame);
+
+    void (*wait_idle)(void);
+
+    // N_DISPLAY_CAP_SCALE: send a scaled view before the frame
+    void (*send_view)(const pixel_t *view, int width, int height);
+
+    // N_DISPLAY_CAP_LINES: start the automap lines of the next frame, in
+    // 1/16 pixels. add_map_line returns false when out of room. end_map
+    // is called when the automap closes.
+    void (*start_map)(int background);
+    boolean (*add_map_line)(int x0, int y0, int x1, int y1, int color);
+    void (*end_map)(void);
+} n_display_backend_t;
+
+extern const n_display_backend_t N_display_ft810;
+extern const n_display_backend_t N_display_null;
+extern const n_display_backend_t N_display_rgb565;
+
+#endif
@@ -0,0 +1,481 @@
+/*
+ * Copyright (c) 2019 - 2020, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+// FT810 display backend. Frames are sent to RAM_G and composed by display
+// lists, which also scale them up to 640x480.
+
+#include <string.h>
+
+#include "doomtype.h"
+#include "i_video.h"
+#include "z_zone.h"
+
+#include "n_display.h"
+#include "n_display_backend.h"
+
+#include "FT810.h"
+
+// Bitmap transform from 320x200 to 640x480 (inverse scale, 8.8 fixed point)
+#define DISPLAY_TRANSFORM_A ((int16_t)(256/2.0))
+#define DISPLAY_TRANSFORM_E ((int16_t)(256/2.4))
+#define DISPLAY_WIDTH  640
+#define DISPLAY_HEIGHT 480
+
+// Palette index left transparent where something is drawn over the view
+#define OVERLAY_TRANSPARENT 251
+
+static uint8_t display_pal[DISPLAY_PALETTE_SIZE];
+
+static int current_dl;
+static int current_statusbar;
+static int current_view;
+
+// Display list commands for the automap lines of the last two frames,
+// one frame is drawn while the next is built. 12.8 KB, only allocated
+// while the automap is open.
+#define DISPLAY_MAP_SIZE 1600
+static uint32_t (*display_map_cmds)[DISPLAY_MAP_SIZE];
+static boolean display_map_open;
+static int current_map;
+static int display_map_size;
+static int display_map_color;
+
+// Memory references for display driver memory
+static uint32_t display_vbuffer_locs[3]; // Frame buffer
+static uint32_t display_palette_locs[3]; // Pallette, and a copy for overlays
+static uint32_t display_statusbar_locs[3]; // Status bar layer
+static uint32_t display_view_locs[3]; // Scaled view
+
+// What each frame buffer holds
+typedef struct
+{
+    int rows;           // Rows above the status bar layer
+    int statusbar;      // Status bar layer slot
+    int view;           // Scaled view slot, -1 when not scaled
+    int view_width;
+    int view_height;
+    int overlay_top;    // Rows of the frame buffer drawn over the view
+    int overlay_rows;
+    const uint32_t *map_cmds; // Automap lines
+    int map_size;
+} display_frame_t;
+
+static display_frame_t display_frames[3] =
+{
+    { .rows = SCREENHEIGHT, .statusbar = 0, .view = -1 },
+    { .rows = SCREENHEIGHT, .statusbar = 0, .view = -1 },
+    { .rows = SCREENHEIGHT, .statusbar = 0, .view = -1 },
+};
+
+// Height on the display of the first rows of a scaled bitmap
+static int N_ft810_DisplayHeight(int rows)
+{
+    int height = (rows*256 + DISPLAY_TRANSFORM_E - 1) / DISPLAY_TRANSFORM_E;
+    return height < DISPLAY_HEIGHT ? height : DISPLAY_HEIGHT;
+}
+
+static void N_ft810_SetupBitmapHandle(int handle, uint32_t loc,
+                                      int width, int rows, int height)
+{
+    dl(FT810_BITMAP_HANDLE(handle));
+    dl(FT810_BITMAP_LAYOUT(PALETTED8, width, rows));
+    dl(FT810_BITMAP_SIZE(NEAREST, BORDER, BORDER, DISPLAY_WIDTH&0x1FF, height));
+    dl(FT810_BITMAP_SIZE_H(DISPLAY_WIDTH>>9, 0));
+    dl(FT810_BITMAP_SOURCE(loc));
+}
+
+// The bitmap transform is not part of the bitmap handle, it is set before
+// each bitmap is drawn. b and d swap the axes of a transposed bitmap.
+static void N_ft810_BitmapTransform(int a, int b, int d, int e)
+{
+    dl(FT810_BITMAP_TRANSFORM_A(a));
+    dl(FT810_BITMAP_TRANSFORM_B(b));
+    dl(FT810_BITMAP_TRANSFORM_D(d));
+    dl(FT810_BITMAP_TRANSFORM_E(e));
+}
+
+// PALETTED8 bitmaps are drawn in four passes, alpha first and then one
+// pass per colour channel.
+static void N_ft810_DrawPalettedBitmap(int handle, uint32_t pal_loc)
+{
+    dl(FT810_BLEND_FUNC(ONE, ZERO));
+
+    dl(FT810_COLOR_MASK(0,0,0,1));
+    dl(FT810_PALETTE_SOURCE(pal_loc+3));
+    dl(FT810_VERTEX2II(0, 0, handle, 0));
+
+    dl(FT810_BLEND_FUNC(DST_ALPHA, ONE_MINUS_DST_ALPHA));
+    dl(FT810_COLOR_MASK(1,0,0,0));
+    dl(FT810_PALETTE_SOURCE(pal_loc));
+    dl(FT810_VERTEX2II(0, 0, handle, 0));
+
+    dl(FT810_COLOR_MASK(0,1,0,0));
+    dl(FT810_PALETTE_SOURCE(pal_loc+1));
+    dl(FT810_VERTEX2II(0, 0, handle, 0));
+
+    dl(FT810_COLOR_MASK(0,0,1,0));
+    dl(FT810_PALETTE_SOURCE(pal_loc+2));
+    dl(FT810_VERTEX2II(0, 0, handle, 0));
+}
+
+// The status bar layer is drawn below the first rows of the frame, unless
+// the frame buffer holds a full frame. A scaled view or the automap lines
+// are drawn over the rows above the status bar, below the rows of the
+// frame buffer drawn over them.
+static void N_ft810_WriteDisplayList(int frame)
+{
+    display_frame_t *f = &display_frames[frame];
+    uint32_t pal_loc = display_palette_locs[frame];
+    uint32_t vbuffer_loc = display_vbuffer_locs[frame];
+    int view_height = N_ft810_DisplayHeight(f->rows);
+    int overlay_y = f->overlay_top*256*16/DISPLAY_TRANSFORM_E;
+
+    dl_start();
+
+    dl(FT810_CLEAR_COLOR_RGB(0x00, 0x00, 0x00));
+    dl(FT810_CLEAR(1,1,1));  // Clear color, stencil, tag
+    dl(FT810_CLEAR_COLOR_RGB(0x00, 0x00, 0x00));
+    dl(FT810_CLEAR(1,0,0));  // Clear color
+
+    if (f->view < 0)
+    {
+        N_ft810_SetupBitmapHandle(0, vbuffer_loc, SCREENWIDTH, f->rows,
+                                  view_height);
+    }
+    else
+    {
+#if VIEW_UPLOAD_TRANSPOSED
+        // Uploaded a column per line, the display reads it across
+        N_ft810_SetupBitmapHandle(0, display_view_locs[f->view],
+                                  f->view_height, f->view_width,
+                                  view_height);
+#else
+        N_ft810_SetupBitmapHandle(0, display_view_locs[f->view],
+                                  f->view_width, f->view_height,
+                                  view_height);
+#endif
+    }
+    if (f->rows < SCREENHEIGHT)
+    {
+        N_ft810_SetupBitmapHandle(1, display_statusbar_locs[f->statusbar],
+                                  SCREENWIDTH, STATUSBARHEIGHT,
+                                  DISPLAY_HEIGHT - view_height);
+    }
+    if (f->overlay_rows > 0)
+    {
+        N_ft810_SetupBitmapHandle(2, vbuffer_loc + f->overlay_top*SCREENWIDTH,
+                                  SCREENWIDTH, f->overlay_rows,
+                                  N_ft810_DisplayHeight(f->overlay_rows));
+    }
+
+    dl(FT810_VERTEX_TRANSLATE_X(80*16));
+    // dl(FT810_VERTEX_TRANSLATE_Y(0*16));
+
+    if (f->map_size > 0)
+    {
+        dl_block(f->map_cmds, f->map_size);
+        dl(FT810_END());
+    }
+
+    dl(FT810_COLOR_RGB(0xFF, 0xFF, 0xFF));
+
+    dl(FT810_BEGIN(BITMAPS));
+    {
+        if (f->map_size == 0)
+        {
+            if (f->view < 0)
+            {
+                N_ft810_BitmapTransform(DISPLAY_TRANSFORM_A, 0,
+                                        0, DISPLAY_TRANSFORM_E);
+            }
+            else
+            {
+#if VIEW_UPLOAD_TRANSPOSED
+                N_ft810_BitmapTransform(0, f->view_height*256/view_height,
+                                        f->view_width*256/DISPLAY_WIDTH, 0);
+#else
+                N_ft810_BitmapTransform(f->view_width*256/DISPLAY_WIDTH, 0,
+                                        0, f->view_height*256/view_height);
+#endif
+            }
+            N_ft810_DrawPalettedBitmap(0, pal_loc);
+        }
+
+        N_ft810_BitmapTransform(DISPLAY_TRANSFORM_A, 0,
+                                0, DISPLAY_TRANSFORM_E);
+
+        if (f->rows < SCREENHEIGHT)
+        {
+            dl(FT810_VERTEX_TRANSLATE_Y(view_height*16));
+            N_ft810_DrawPalettedBitmap(1, pal_loc);
+        }
+
+        if (f->overlay_rows > 0)
+        {
+            dl(FT810_VERTEX_TRANSLATE_Y(overlay_y));
+            N_ft810_DrawPalettedBitmap(2, pal_loc + DISPLAY_PALETTE_SIZE);
+        }
+    }
+    dl(FT810_END());
+
+    dl_end();
+
+    N_display_dlswap_frame();
+}
+
+static void N_ft810_Init(void)
+{
+    N_display_init();
+    display_palette_locs[0] = N_display_ram_alloc(DISPLAY_PALETTE_SIZE*2);
+    display_palette_locs[1] = N_display_ram_alloc(DISPLAY_PALETTE_SIZE*2);
+    display_palette_locs[2] = N_display_ram_alloc(DISPLAY_PALETTE_SIZE*2);
+    display_vbuffer_locs[0] = N_display_ram_alloc(SCREENWIDTH*SCREENHEIGHT);
+    display_vbuffer_locs[1] = N_display_ram_alloc(SCREENWIDTH*SCREENHEIGHT);
+    display_vbuffer_locs[2] = N_display_ram_alloc(SCREENWIDTH*SCREENHEIGHT);
+    display_statusbar_locs[0] = N_display_ram_alloc(SCREENWIDTH*STATUSBARHEIGHT);
+    display_statusbar_locs[1] = N_display_ram_alloc(SCREENWIDTH*STATUSBARHEIGHT);
+    display_statusbar_locs[2] = N_display_ram_alloc(SCREENWIDTH*STATUSBARHEIGHT);
+    display_view_locs[0] = N_display_ram_alloc(SCREENWIDTH*SCREENHEIGHT);
+    display_view_locs[1] = N_display_ram_alloc(SCREENWIDTH*SCREENHEIGHT);
+    display_view_locs[2] = N_display_ram_alloc(SCREENWIDTH*SCREENHEIGHT);
+
+    current_dl = 1;
+
+    // N_ft810_WriteDisplayList(0);
+    // N_ft810_WriteDisplayList(1);
+}
+
+static void N_ft810_SetPalette(const byte *palette)
+{
+    int i;
+
+    for (i=0; i<256; ++i)
+    {
+        display_pal[i*4+0] = *palette++;
+        display_pal[i*4+1] = *palette++;
+        display_pal[i*4+2] = *palette++;
+        display_pal[i*4+3] = 0xFF;
+    }
+}
+
+// Send the scaled view to the next view slot
+static void N_ft810_SendView(const pixel_t *view, int width, int height)
+{
+    // Wait for previous frame buffer transfer to finish
+    N_display_spi_transfer_finish();
+
+    current_view = (current_view+1)%3;
+    N_display_spi_wr(display_view_locs[current_view], width*height,
+                     (uint8_t*)view);
+    N_display_spi_transfer_finish();
+}
+
+static void N_ft810_SubmitFrame(const n_display_frame_t *f)
+{
+    display_frame_t *frame;
+    int size;
+
+    // Wait for previous frame buffer transfer to finish
+    N_display_spi_transfer_finish();
+
+    // Instruct display to start drawing previous frame
+    N_ft810_WriteDisplayList(current_dl);
+
+    // The last automap lines are in the display list now
+    if (!display_map_open && display_map_cmds != NULL)
+    {
+        Z_Free(display_map_cmds);
+        display_map_cmds = NULL;
+    }
+
+    current_dl = (current_dl+1)%3;
+    frame = &display_frames[current_dl];
+
+    // Do complete palette data transfer
+    N_display_spi_wr(display_palette_locs[current_dl], DISPLAY_PALETTE_SIZE, display_pal);
+    N_display_spi_transfer_finish();
+
+    if (f->rows < SCREENHEIGHT)
+    {
+        // Only send the status bar when it has changed. Rotating through
+        // three buffers keeps clear of the ones referenced by the display
+        // lists that may still be on screen.
+        if (f->statusbar != NULL)
+        {
+            current_statusbar = (current_statusbar+1)%3;
+            N_display_spi_wr(display_statusbar_locs[current_statusbar],
+                             SCREENWIDTH*STATUSBARHEIGHT,
+                             (uint8_t*)f->statusbar);
+            N_display_spi_transfer_finish();
+        }
+        frame->statusbar = current_statusbar;
+    }
+    frame->rows = f->rows;
+    frame->map_size = 0;
+    frame->overlay_top = f->overlay_top;
+    frame->overlay_rows = f->overlay_rows;
+
+    if (f->view_width == 0 && !f->map)
+    {
+        frame->view = -1;
+
+        // Start frame buffer transfer
+        N_display_spi_wr(display_vbuffer_locs[current_dl],
+                         SCREENWIDTH*frame->rows,
+                         (uint8_t*)f->buffer);
+        return;
+    }
+
+    if (frame->overlay_rows > 0)
+    {
+        N_display_spi_wr(display_palette_locs[current_dl] + DISPLAY_PALETTE_SIZE,
+                         DISPLAY_PALETTE_SIZE, display_pal);
+        N_display_spi_transfer_finish();
+        N_display_spi_wr8(display_palette_locs[current_dl] + DISPLAY_PALETTE_SIZE
+                          + OVERLAY_TRANSPARENT*4 + 3, 0);
+
+        N_display_spi_wr(display_vbuffer_locs[current_dl]
+                             + f->overlay_top*SCREENWIDTH,
+                         SCREENWIDTH*f->overlay_rows,
+                         (uint8_t*)f->buffer + f->overlay_top*SCREENWIDTH);
+    }
+
+    if (f->map)
+    {
+        frame->view = -1;
+        frame->map_cmds = display_map_cmds[current_map];
+        frame->map_size = display_map_size;
+        return;
+    }
+
+    // Start view transfer
+    if (!f->view_sent)
+    {
+        size = f->view_width*f->view_height;
+
+        N_display_spi_transfer_finish();
+        current_view = (current_view+1)%3;
+        N_display_spi_wr(display_view_locs[current_view], size,
+                         (uint8_t*)f->buffer + SCREENWIDTH*SCREENHEIGHT - size);
+    }
+    frame->view = current_view;
+    frame->view_width = f->view_width;
+    frame->view_height = f->view_height;
+}
+
+static void N_ft810_WaitIdle(void)
+{
+    N_display_spi_transfer_finish();
+}
+
+// Display lines are in 1/16 pixels of the display
+static boolean N_ft810_AddMapCommand(uint32_t cmd)
+{
+    if (display_map_size == DISPLAY_MAP_SIZE)
+    {
+        return false;
+    }
+    display_map_cmds[current_map][display_map_size++] = cmd;
+    return true;
+}
+
+static uint32_t N_ft810_MapColor(int color)
+{
+    return FT810_COLOR_RGB(display_pal[color*4+0],
+                           display_pal[color*4+1],
+                           display_pal[color*4+2]);
+}
+
+static void N_ft810_StartMap(int background)
+{
+    int height = (SCREENHEIGHT-STATUSBARHEIGHT)*256*16/DISPLAY_TRANSFORM_E;
+
+    if (display_map_cmds == NULL)
+    {
+        display_map_cmds = Z_Malloc(2*DISPLAY_MAP_SIZE*sizeof(uint32_t),
+                                    PU_STATIC, NULL);
+    }
+    display_map_open = true;
+
+    current_map ^= 1;
+    display_map_size = 0;
+    display_map_color = background;
+
+    N_ft810_AddMapCommand(N_ft810_MapColor(background));
+    N_ft810_AddMapCommand(FT810_BEGIN(RECTS));
+    N_ft810_AddMapCommand(FT810_VERTEX2F(0, 0));
+    N_ft810_AddMapCommand(FT810_VERTEX2F(DISPLAY_WIDTH*16, height));
+    N_ft810_AddMapCommand(FT810_LINE_WIDTH(16));
+    N_ft810_AddMapCommand(FT810_BEGIN(LINES));
+}
+
+static boolean N_ft810_AddMapLine(int x0, int y0, int x1, int y1, int color)
+{
+    // One frame buffer pixel is two display pixels wide
+    x0 = x0*DISPLAY_WIDTH/SCREENWIDTH;
+    x1 = x1*DISPLAY_WIDTH/SCREENWIDTH;
+    y0 = y0*256/DISPLAY_TRANSFORM_E;
+    y1 = y1*256/DISPLAY_TRANSFORM_E;
+
+    if (display_map_size + 3 > DISPLAY_MAP_SIZE)
+    {
+        return false;
+    }
+    if (color != display_map_color)
+    {
+        N_ft810_AddMapCommand(N_ft810_MapColor(color));
+        display_map_color = color;
+    }
+    N_ft810_AddMapCommand(FT810_VERTEX2F(x0, y0));
+    N_ft810_AddMapCommand(FT810_VERTEX2F(x1, y1));
+    return true;
+}
+
+// The buffers are freed once the last lines are in a display list
+static void N_ft810_EndMap(void)
+{
+    display_map_open = false;
+}
+
+const n_display_backend_t N_display_ft810 =
+{
+    "FT810",
+    N_DISPLAY_CAP_LAYERS | N_DISPLAY_CAP_SCALE | N_DISPLAY_CAP_LINES,
+    N_ft810_Init,
+    N_ft810_SetPalette,
+    N_ft810_SubmitFrame,
+    N_ft810_WaitIdle,
+    N_ft810_SendView,
+    N_ft810_StartMap,
+    N_ft810_AddMapLine,
+    N_ft810_EndMap,
+};
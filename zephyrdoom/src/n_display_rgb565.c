@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2019 - 2020, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+// Display backend for panels without a hardware palette. Frames are
+// converted to RGB565 a band of rows at a time, through a palette lookup
+// table, and each band is sent while the next one is converted. A full
+// RGB565 frame would need another 128 KB of RAM.
+//
+// On this board the bands go to FT810 RAM_G and are shown as an RGB565
+// bitmap, which exercises the same path as an SPI panel (-rgb565).
+
+#include <string.h>
+
+#include "doomtype.h"
+#include "i_video.h"
+#include "z_zone.h"
+
+#include "n_display.h"
+#include "n_display_backend.h"
+
+#include "FT810.h"
+
+// Rows converted at a time
+#ifndef RGB565_BAND_ROWS
+#define RGB565_BAND_ROWS 4
+#endif
+
+// One band is sent while the other is converted
+#define RGB565_BANDS 2
+
+#define DISPLAY_TRANSFORM_A ((int16_t)(256/2.0))
+#define DISPLAY_TRANSFORM_E ((int16_t)(256/2.4))
+#define DISPLAY_WIDTH  640
+#define DISPLAY_HEIGHT 480
+
+// NRFD-NOTE: The FT810 takes RGB565 little endian. Panels like the
+// ILI9341 take it big endian over SPI, so their table would be byte
+// swapped instead.
+// The table and the bands are only allocated when this backend is used,
+// 512 bytes and 5 KB with the default band.
+static uint16_t *rgb565_lut;
+
+static uint16_t (*rgb565_bands)[SCREENWIDTH*RGB565_BAND_ROWS];
+static int current_band;
+
+static uint32_t rgb565_vbuffer_locs[3];
+static int current_dl;
+
+static void N_rgb565_WriteDisplayList(int frame)
+{
+    dl_start();
+
+    dl(FT810_CLEAR_COLOR_RGB(0x00, 0x00, 0x00));
+    dl(FT810_CLEAR(1,1,1));  // Clear color, stencil, tag
+
+    dl(FT810_BITMAP_HANDLE(0));
+    dl(FT810_BITMAP_LAYOUT(RGB565, SCREENWIDTH*2, SCREENHEIGHT));
+    dl(FT810_BITMAP_TRANSFORM_A(DISPLAY_TRANSFORM_A));
+    dl(FT810_BITMAP_TRANSFORM_E(DISPLAY_TRANSFORM_E));
+    dl(FT810_BITMAP_SIZE(NEAREST, BORDER, BORDER, DISPLAY_WIDTH&0x1FF, DISPLAY_HEIGHT&0x1FF));
+    dl(FT810_BITMAP_SIZE_H(DISPLAY_WIDTH>>9, DISPLAY_HEIGHT>>9));
+    dl(FT810_BITMAP_SOURCE(rgb565_vbuffer_locs[frame]));
+
+    dl(FT810_VERTEX_TRANSLATE_X(80*16));
+
+    dl(FT810_COLOR_RGB(0xFF, 0xFF, 0xFF));
+    dl(FT810_BEGIN(BITMAPS));
+    dl(FT810_VERTEX2II(0, 0, 0, 0));
+    dl(FT810_END());
+
+    dl_end();
+
+    N_display_dlswap_frame();
+}
+
+static void N_rgb565_Init(void)
+{
+    N_display_init();
+    rgb565_vbuffer_locs[0] = N_display_ram_alloc(SCREENWIDTH*SCREENHEIGHT*2);
+    rgb565_vbuffer_locs[1] = N_display_ram_alloc(SCREENWIDTH*SCREENHEIGHT*2);
+    rgb565_vbuffer_locs[2] = N_display_ram_alloc(SCREENWIDTH*SCREENHEIGHT*2);
+
+    rgb565_lut = Z_Malloc(256*sizeof(*rgb565_lut), PU_STATIC, NULL);
+    rgb565_bands = Z_Malloc(RGB565_BANDS*sizeof(*rgb565_bands),
+                            PU_STATIC, NULL);
+
+    current_dl = 1;
+}
+
+static void N_rgb565_SetPalette(const byte *palette)
+{
+    int i;
+
+    for (i=0; i<256; ++i)
+    {
+        rgb565_lut[i] = ((palette[0] & 0xF8) << 8)
+                      | ((palette[1] & 0xFC) << 3)
+                      | (palette[2] >> 3);
+        palette += 3;
+    }
+}
+
+// Convert pixels four at a time. Both pointers are word aligned and the
+// count is a multiple of four.
+static void N_rgb565_Convert(uint16_t *dest, const pixel_t *src, int count)
+{
+    const uint32_t *src4 = (const uint32_t *)src;
+    uint32_t *dest2 = (uint32_t *)dest;
+    uint32_t p;
+
+    for (; count > 0; count -= 4)
+    {
+        p = *src4++;
+        *dest2++ = rgb565_lut[p & 0xFF] | (rgb565_lut[(p >> 8) & 0xFF] << 16);
+        *dest2++ = rgb565_lut[(p >> 16) & 0xFF] | (rgb565_lut[p >> 24] << 16);
+    }
+}
+
+// Send rows of the frame. Sending a band waits for the one before it,
+// which leaves the other band free to convert into.
+static void N_rgb565_SendRows(uint32_t loc, const pixel_t *buffer,
+                              int y, int height)
+{
+    uint16_t *band;
+    int rows;
+
+    while (height > 0)
+    {
+        rows = height < RGB565_BAND_ROWS ? height : RGB565_BAND_ROWS;
+        band = rgb565_bands[current_band];
+        current_band = (current_band+1)%RGB565_BANDS;
+
+        N_rgb565_Convert(band, buffer + y*SCREENWIDTH, rows*SCREENWIDTH);
+        N_display_spi_wr(loc + y*SCREENWIDTH*2, rows*SCREENWIDTH*2,
+                         (uint8_t*)band);
+
+        y += rows;
+        height -= rows;
+    }
+}
+
+static void N_rgb565_SubmitFrame(const n_display_frame_t *f)
+{
+    // Wait for previous frame buffer transfer to finish
+    N_display_spi_transfer_finish();
+
+    // Instruct display to start drawing previous frame
+    N_rgb565_WriteDisplayList(current_dl);
+
+    current_dl = (current_dl+1)%3;
+
+    N_rgb565_SendRows(rgb565_vbuffer_locs[current_dl], f->buffer,
+                      0, SCREENHEIGHT);
+}
+
+static void N_rgb565_WaitIdle(void)
+{
+    N_display_spi_transfer_finish();
+}
+
+const n_display_backend_t N_display_rgb565 =
+{
+    "RGB565",
+    0,
+    N_rgb565_Init,
+    N_rgb565_SetPalette,
+    N_rgb565_SubmitFrame,
+    N_rgb565_WaitIdle,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+};
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2019 - 2020, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+// Host benchmark of the RGB565 conversion, not part of the firmware.
+// Converts a frame a band at a time, the way N_rgb565_SendRows does, for
+// a range of band heights, and against a plain pixel at a time loop.
+// The SPI transfer is left out, so this only shows what the band height
+// costs in conversion.
+//
+// Build and run from this directory:
+//
+//     cc -O2 -I. -Iconfig n_display_rgb565_host.c
+//     ./a.out
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Room for the largest band timed
+#define RGB565_BAND_ROWS 40
+
+#include "n_display_rgb565.c"
+
+#define HOST_FRAMES 200
+#define HOST_RUNS   10
+
+// Stand-ins for the display and zone functions the backend uses
+void N_display_init() {}
+uint32_t N_display_ram_alloc(size_t size) { return 0; }
+void N_display_spi_transfer_finish() {}
+void N_display_spi_wr(uint32_t addr, int dataSize, uint8_t *data) {}
+void N_display_dlswap_frame() {}
+void dl_start() {}
+void dl(uint32_t cmd) {}
+void dl_end() {}
+
+void *Z_Malloc(int size, int tag, void *user)
+{
+    return malloc(size);
+}
+
+static pixel_t frame[SCREENWIDTH*SCREENHEIGHT] __attribute__((aligned(4)));
+static volatile uint16_t sink;
+
+static double NowUS(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+// Pixel at a time, the loop N_rgb565_Convert replaced
+static void ConvertPlain(uint16_t *dest, const pixel_t *src, int count)
+{
+    while (count-- > 0)
+    {
+        *dest++ = rgb565_lut[*src++];
+    }
+}
+
+// One frame, a band at a time
+static void ConvertFrame(int band_rows, boolean plain)
+{
+    uint16_t *band;
+    int y, rows;
+
+    for (y = 0; y < SCREENHEIGHT; y += rows)
+    {
+        rows = SCREENHEIGHT - y < band_rows ? SCREENHEIGHT - y : band_rows;
+        band = rgb565_bands[current_band];
+        current_band = (current_band+1)%RGB565_BANDS;
+
+        if (plain)
+        {
+            ConvertPlain(band, frame + y*SCREENWIDTH, rows*SCREENWIDTH);
+        }
+        else
+        {
+            N_rgb565_Convert(band, frame + y*SCREENWIDTH, rows*SCREENWIDTH);
+        }
+        sink = band[0];
+    }
+}
+
+// Best of HOST_RUNS, in us per frame
+static double TimeFrames(int band_rows, boolean plain)
+{
+    double best = 0;
+    double start, time;
+    int run, n;
+
+    for (run = 0; run < HOST_RUNS; run++)
+    {
+        start = NowUS();
+        for (n = 0; n < HOST_FRAMES; n++)
+        {
+            ConvertFrame(band_rows, plain);
+        }
+        time = (NowUS() - start) / HOST_FRAMES;
+
+        if (run == 0 || time < best)
+        {
+            best = time;
+        }
+    }
+
+    return best;
+}
+
+int main(void)
+{
+    static const int band_rows[] = { 1, 2, 4, 8, 10, 20, 40 };
+    byte palette[256*3];
+    unsigned int i;
+
+    for (i = 0; i < sizeof(palette); i++)
+    {
+        palette[i] = rand();
+    }
+    for (i = 0; i < sizeof(frame); i++)
+    {
+        frame[i] = rand();
+    }
+
+    N_rgb565_Init();
+    N_rgb565_SetPalette(palette);
+
+    printf("rows  band bytes  us/frame  plain us/frame\n");
+    for (i = 0; i < sizeof(band_rows)/sizeof(band_rows[0]); i++)
+    {
+        printf("%4d  %10d  %8.1f  %14.1f\n", band_rows[i],
+               band_rows[i] * SCREENWIDTH * 2 * RGB565_BANDS,
+               TimeFrames(band_rows[i], false),
+               TimeFrames(band_rows[i], true));
+    }
+
+    return 0;
+}
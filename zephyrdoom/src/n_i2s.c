@@ -2,8 +2,10 @@
  * Zephyr RTOS I2S-based backend for Doom audio (nRF5340 → PCM5102A / MAX98357).
  *
  * Keeps the N_I2S_* API used by the Doom mixer, but routes audio via Zephyr's
- * i2s_buf_write() from a dedicated high-priority feeder thread. If no mixed
- * block is available, the feeder writes silence to avoid underruns.
+ * i2s_write() from a dedicated high-priority feeder thread. The mixer mixes
+ * straight into blocks of the driver's TX slab and queues them for the
+ * feeder. If no mixed block is available in time, the feeder writes silence
+ * to avoid underruns.
  */
 
 #include "n_i2s.h"
@@ -16,31 +18,33 @@
 #include <zephyr/sys/atomic.h>
 #include <zephyr/sys/printk.h>
 
-#define SAMPLE_RATE 11025
+#define SAMPLE_RATE N_I2S_SAMPLE_RATE
 #define SAMPLE_BIT_WIDTH 16
 #define NUM_CHANNELS 2
 #define BYTES_PER_SAMPLE 2
 
 /* BUFFER_SIZE is the number of int16_t samples in a block (interleaved L/R). */
 #define BUFFER_SIZE 512 /* 256 frames x stereo */
-#define NUM_BUFFERS 5
 #define BUFFER_SIZE_BYTES (BUFFER_SIZE * BYTES_PER_SAMPLE)
+#define BUFFER_MS ((BUFFER_SIZE / NUM_CHANNELS) * 1000 / SAMPLE_RATE)
 
-typedef enum {
-    BUF_EMPTY = 0,
-    BUF_FILLED = 1,
-} buffer_state_t;
+/*
+ * Blocks shared by the mixer and the driver. The mixer takes a block as
+ * soon as the driver frees one, so every block is BUFFER_MS of latency.
+ * Four leave the driver three to play while one is mixed.
+ */
+#define NUM_BLOCKS 4
 
 static boolean i2s_started;
 
-static int16_t sampleBuffers[NUM_BUFFERS][BUFFER_SIZE];
-static buffer_state_t bufferStates[NUM_BUFFERS];
-static int queuedBuffer;
-static int16_t zeros[BUFFER_SIZE];
+static void *mixBlock; /* Block being mixed into */
 
-/* Zephyr I2S device + TX slab for the driver's internal queue */
+/* Zephyr I2S device + TX slab the mixer writes into */
 #define I2S_DEV DT_NODELABEL(i2s0)
-K_MEM_SLAB_DEFINE(tx_mem_slab, BUFFER_SIZE_BYTES, 4, 4);
+K_MEM_SLAB_DEFINE(tx_mem_slab, BUFFER_SIZE_BYTES, NUM_BLOCKS, 4);
+
+/* Mixed blocks for the feeder */
+K_MSGQ_DEFINE(mixed_queue, sizeof(void *), NUM_BLOCKS, 4);
 
 #define AUDIO_STACK_SIZE 2048
 #define AUDIO_PRIO -1
@@ -49,37 +53,40 @@ static struct k_thread audio_thread;
 
 static const struct device *i2s_dev;
 static atomic_t g_recoveries = ATOMIC_INIT(0);
+static atomic_t g_underruns = ATOMIC_INIT(0);
 
-static void zero_buffer(int bufIdx) {
-    int j;
-    for (j = 0; j < BUFFER_SIZE; j++) {
-        sampleBuffers[bufIdx][j] = 0;
-    }
-}
+/*
+ * Next block to send: the next mixed block, or silence if the mixer hasn't
+ * queued one within a block's time. Silence is only sent while a slab
+ * block is free, which is never the case while the mixer is waiting for
+ * one.
+ */
+static void *i2s_next_block(void) {
+    void *block;
 
-static void clear_buffers(void) {
-    int i;
-    for (i = 0; i < NUM_BUFFERS; i++) {
-        zero_buffer(i);
-        bufferStates[i] = BUF_EMPTY;
+    for (;;) {
+        if (k_msgq_get(&mixed_queue, &block, K_MSEC(BUFFER_MS)) == 0) {
+            return block;
+        }
+        if (k_mem_slab_alloc(&tx_mem_slab, &block, K_NO_WAIT) == 0) {
+            memset(block, 0, BUFFER_SIZE_BYTES);
+            atomic_inc(&g_underruns);
+            return block;
+        }
     }
 }
 
-static int i2s_write_block(void *payload) {
-    int r;
-    do {
-        r = i2s_buf_write(i2s_dev, payload, BUFFER_SIZE_BYTES);
-        if (r == -EAGAIN) {
-            k_sleep(K_MSEC(1));
-        }
-    } while (r == -EAGAIN);
+/* The driver frees the block once played, or here if it won't take it */
+static int i2s_send_block(void *block) {
+    int r = i2s_write(i2s_dev, block, BUFFER_SIZE_BYTES);
+    if (r < 0) {
+        k_mem_slab_free(&tx_mem_slab, block);
+    }
     return r;
 }
 
 static void audio_feeder(void *a, void *b, void *c) {
     struct i2s_config cfg;
-    int idx;
-    void *payload;
     int r;
 
     i2s_dev = DEVICE_DT_GET(I2S_DEV);
@@ -101,9 +108,9 @@ static void audio_feeder(void *a, void *b, void *c) {
         return;
     }
 
-    /* Prefill with silence to prime the queue */
-    (void)i2s_write_block(zeros);
-    (void)i2s_write_block(zeros);
+    /* Prime the queue */
+    (void)i2s_send_block(i2s_next_block());
+    (void)i2s_send_block(i2s_next_block());
 
     if (i2s_trigger(i2s_dev, I2S_DIR_TX, I2S_TRIGGER_START) < 0) {
         printk("I2S START failed\n");
@@ -111,54 +118,44 @@ static void audio_feeder(void *a, void *b, void *c) {
     }
 
     for (;;) {
-        /* Advance ring index */
-        queuedBuffer = (queuedBuffer + 1) % NUM_BUFFERS;
-        idx = queuedBuffer;
-
-        if (bufferStates[idx] == BUF_FILLED) {
-            payload = sampleBuffers[idx];
-        } else {
-            payload = zeros; /* fallback to silence */
-        }
-
-        r = i2s_write_block(payload);
+        r = i2s_send_block(i2s_next_block());
         if (r < 0) {
             atomic_inc(&g_recoveries);
             printk("audio: write=%d, recovering\n", r);
             (void)i2s_trigger(i2s_dev, I2S_DIR_TX, I2S_TRIGGER_STOP);
             (void)i2s_trigger(i2s_dev, I2S_DIR_TX, I2S_TRIGGER_DROP);
-            (void)i2s_write_block(zeros);
-            (void)i2s_write_block(zeros);
+            (void)i2s_send_block(i2s_next_block());
+            (void)i2s_send_block(i2s_next_block());
             (void)i2s_trigger(i2s_dev, I2S_DIR_TX, I2S_TRIGGER_START);
         }
-
-        /* Recycle the buffer slot after enqueue (copy-based API) */
-        if (payload == sampleBuffers[idx]) {
-            bufferStates[idx] = BUF_EMPTY;
-        }
-
-        k_yield();
     }
 }
 
 void N_I2S_init(void) {
     printf("N_I2S_init (Zephyr I2S)\n");
-    memset(zeros, 0, sizeof(zeros));
-    clear_buffers();
-    queuedBuffer = 0;
+    mixBlock = NULL;
     i2s_started = false;
 }
 
-boolean N_I2S_next_buffer(int *buf_size, int16_t **buffer) {
-    int next;
-    next = (queuedBuffer + 1) % NUM_BUFFERS;
-    if (bufferStates[next] == BUF_EMPTY) {
-        *buf_size = BUFFER_SIZE;
-        *buffer = sampleBuffers[next];
-        bufferStates[next] = BUF_FILLED;
-        return true;
+boolean N_I2S_next_buffer(int *buf_size, int16_t **buffer, boolean wait) {
+    if (k_mem_slab_alloc(&tx_mem_slab, &mixBlock,
+                         wait ? K_FOREVER : K_NO_WAIT) != 0) {
+        return false;
     }
-    return false;
+    *buf_size = BUFFER_SIZE;
+    *buffer = mixBlock;
+    return true;
+}
+
+void N_I2S_submit_buffer(void) {
+    /* The queue holds every block, so this doesn't wait */
+    (void)k_msgq_put(&mixed_queue, &mixBlock, K_NO_WAIT);
+    mixBlock = NULL;
+}
+
+void N_I2S_get_stats(n_i2s_stats_t *stats) {
+    stats->underruns = atomic_get(&g_underruns);
+    stats->recoveries = atomic_get(&g_recoveries);
 }
 
 void N_I2S_process(void) {
@@ -33,6 +33,24 @@
 
 #include "doomtype.h"
 
+// Output sample rate, in frames per second
+#define N_I2S_SAMPLE_RATE 11025
+
+typedef struct {
+    uint32_t underruns;   // Blocks of silence sent for want of a mixed block
+    uint32_t recoveries;  // Restarts after a failed write
+} n_i2s_stats_t;
+
 void N_I2S_init();
-boolean N_I2S_next_buffer(int *buf_size, int16_t **buffer);
+
+// Get a free block to mix into, waiting for one if wait is set. The block
+// is sent once passed to N_I2S_submit_buffer.
+boolean N_I2S_next_buffer(int *buf_size, int16_t **buffer, boolean wait);
+void N_I2S_submit_buffer(void);
+
 void N_I2S_process();
+
+// Mix frames of music from n_i2s_music.c into the stereo accumulator.
+// Returns false if nothing was added.
+boolean N_I2S_MixMusic(int32_t *accum, int frames);
+void N_I2S_get_stats(n_i2s_stats_t *stats);
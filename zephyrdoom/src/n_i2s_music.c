@@ -0,0 +1,769 @@
+/*
+ * Copyright (c) 2019 - 2020, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+// Music for the I2S sound module. MUS lumps are played straight from the
+// WAD in flash by a small synthesizer: a fixed number of voices reading
+// wavetables built at init, with simple envelopes, mixed into the same
+// blocks as the sound effects.
+
+#include <stdio.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+
+#include "doomtype.h"
+#include "i_sound.h"
+#include "n_i2s.h"
+#include "tables.h"
+#include "z_zone.h"
+
+// Voices playing at once. Each costs about as much to mix as a sound
+// effect channel.
+#ifndef MUSIC_VOICES
+#define MUSIC_VOICES 8
+#endif
+
+#define MUS_CHANNELS 16
+#define MUS_PERCUSSION 15
+#define MUS_TICRATE 140
+
+// Output frames per MUS tic, 16.16
+#define MUS_TIC_FRAMES (((uint32_t)N_I2S_SAMPLE_RATE << 16) / MUS_TICRATE)
+
+// Events handled in one tic at most, in case of a broken score
+#define MUS_MAX_EVENTS 256
+
+typedef enum {
+    MUS_RELEASE_NOTE = 0,
+    MUS_PLAY_NOTE = 1,
+    MUS_PITCH_BEND = 2,
+    MUS_SYSTEM_EVENT = 3,
+    MUS_CONTROLLER = 4,
+    MUS_END_OF_MEASURE = 5,
+    MUS_SCORE_END = 6,
+} mus_event_t;
+
+#define MUS_CTRL_INSTRUMENT 0
+#define MUS_CTRL_VOLUME 3
+#define MUS_CTRL_PAN 4
+#define MUS_SYS_SOUNDS_OFF 10
+#define MUS_SYS_NOTES_OFF 11
+#define MUS_SYS_RESET 14
+
+//
+// Wavetables
+//
+
+#define WAVE_SIZE 256
+
+typedef enum {
+    WAVE_SINE,
+    WAVE_ORGAN,
+    WAVE_SQUARE,
+    WAVE_NOISE,
+    NUM_WAVES,
+} wave_t;
+
+static int8_t waves[NUM_WAVES][WAVE_SIZE];
+
+// Sound of each group of eight General MIDI programs, and whether notes
+// are held while the key is down or die away like a plucked string.
+typedef struct {
+    uint8_t wave;
+    uint8_t sustain;
+} instrument_t;
+
+static const instrument_t instruments_const[16] = {
+    {WAVE_ORGAN, false},  // Piano
+    {WAVE_SINE, false},   // Chromatic percussion
+    {WAVE_ORGAN, true},   // Organ
+    {WAVE_ORGAN, false},  // Guitar
+    {WAVE_SINE, false},   // Bass
+    {WAVE_ORGAN, true},   // Strings
+    {WAVE_ORGAN, true},   // Ensemble
+    {WAVE_SQUARE, true},  // Brass
+    {WAVE_SQUARE, true},  // Reed
+    {WAVE_SINE, true},    // Pipe
+    {WAVE_SQUARE, true},  // Synth lead
+    {WAVE_ORGAN, true},   // Synth pad
+    {WAVE_SQUARE, true},  // Synth effects
+    {WAVE_ORGAN, false},  // Ethnic
+    {WAVE_NOISE, false},  // Percussive
+    {WAVE_NOISE, false},  // Sound effects
+};
+
+// Phase steps of the top octave, notes 108 to 119, for a 32-bit phase at
+// N_I2S_SAMPLE_RATE. Lower octaves are shifted down. Notes above
+// MUSIC_TOP_NOTE are over half the sample rate, a step of 0x80000000 or
+// more, and are played whole octaves lower instead of aliasing.
+#define MUSIC_TOP_NOTE 112
+
+static const uint32_t note_steps_const[12] = {
+    1630727614, 1727695724, 1830429858, 1939272882,
+    2054588048, 2176760211, 2306197109, 2443330725,
+    2588618730, 2742546010, 2905626283, 3078403812,
+};
+
+static uint32_t NoteStep(int note) {
+    if (note > MUSIC_TOP_NOTE) {
+        note -= 12 * ((note - MUSIC_TOP_NOTE - 1) / 12 + 1);
+    }
+    return note_steps_const[note % 12] >> (9 - note / 12);
+}
+
+// Step of a note bent by bend/64 semitones
+static uint32_t BentNoteStep(int note, int bend) {
+    uint32_t step, next;
+
+    note = note * 64 + bend;
+    if (note < 0) {
+        note = 0;
+    } else if (note > MUSIC_TOP_NOTE * 64) {
+        note -= 12 * 64 * ((note - MUSIC_TOP_NOTE * 64 - 1) / (12 * 64) + 1);
+    }
+
+    step = NoteStep(note / 64);
+    if (note % 64 == 0) {
+        return step;
+    }
+    next = NoteStep(note / 64 + 1);
+    return step + (uint32_t)(((uint64_t)(next - step) * (note % 64)) / 64);
+}
+
+static void InitWaves(void) {
+    uint32_t lfsr = 0xACE1;
+    int i;
+
+    for (i = 0; i < WAVE_SIZE; i++) {
+        int angle = i * (FINEANGLES / WAVE_SIZE);
+        int s1 = finesine[angle] >> 9;                     // +-128
+        int s2 = finesine[(angle * 2) & FINEMASK] >> 9;
+        int s3 = finesine[(angle * 3) & FINEMASK] >> 9;
+
+        waves[WAVE_SINE][i] = s1 * 120 / 128;
+        waves[WAVE_ORGAN][i] = (s1 * 3 + s2 * 2 + s3) * 120 / (128 * 6);
+        waves[WAVE_SQUARE][i] = (s1 * 6 + s3 * 2) * 120 / (128 * 6);
+
+        lfsr = (lfsr >> 1) ^ (-(lfsr & 1) & 0xB400);
+        waves[WAVE_NOISE][i] = (int8_t)(lfsr & 0xFF) * 120 / 128;
+    }
+}
+
+//
+// Synthesizer state, owned by the mixer thread
+//
+
+#define ENV_MAX 0x7FFF
+#define ENV_SUSTAIN (ENV_MAX * 3 / 4)
+#define ENV_OFF 0x40
+
+typedef enum {
+    VOICE_FREE,
+    VOICE_ON,
+    VOICE_RELEASED,
+} voice_state_t;
+
+typedef struct {
+    uint32_t phase;
+    uint32_t step;
+    const int8_t *wave;
+    int32_t env;
+    uint32_t age;
+    uint8_t state;
+    uint8_t channel;
+    uint8_t note;
+    uint8_t velocity;
+    boolean sustain;
+} voice_t;
+
+typedef struct {
+    uint8_t instrument;
+    uint8_t volume;
+    uint8_t pan;
+    uint8_t velocity;  // Of the last note, for notes without one
+    int8_t bend;       // In 1/64 semitones
+} mus_channel_t;
+
+static voice_t voices[MUSIC_VOICES];
+static mus_channel_t mus_channels[MUS_CHANNELS];
+static uint32_t voice_age;
+
+static const byte *score;
+static const byte *score_start;
+static const byte *score_end;
+static boolean score_looping;
+static boolean score_playing;
+static boolean score_paused;
+static uint8_t score_seq;
+static uint32_t score_delay;
+static uint32_t tic_frames;
+static int music_volume = 127;
+
+//
+// Commands from the game thread, applied by the mixer before each block,
+// as for the sound effects.
+//
+
+typedef enum {
+    MUSIC_CMD_PLAY,
+    MUSIC_CMD_STOP,
+    MUSIC_CMD_PAUSE,
+    MUSIC_CMD_RESUME,
+    MUSIC_CMD_VOLUME,
+} music_cmd_type_t;
+
+typedef struct {
+    uint8_t type;
+    uint8_t value;  // Looping, or volume
+    uint8_t seq;
+    const byte *score;
+    const byte *end;
+} music_cmd_t;
+
+#define MUSIC_CMD_QUEUE 8  // Power of two
+
+static music_cmd_t cmd_queue[MUSIC_CMD_QUEUE];
+static atomic_t cmd_head;
+static atomic_t cmd_tail;
+
+static uint8_t song_seq;         // Game thread
+static boolean song_playing;     // Game thread
+static atomic_t song_done;       // Mixer, seq of the song that ended
+
+typedef struct {
+    const byte *score;
+    const byte *end;
+} song_t;
+
+static boolean SendMusicCommand(const music_cmd_t *cmd) {
+    atomic_val_t head = atomic_get(&cmd_head);
+
+    if ((uint32_t)head - (uint32_t)atomic_get(&cmd_tail) >= MUSIC_CMD_QUEUE) {
+        return false;
+    }
+
+    cmd_queue[head & (MUSIC_CMD_QUEUE - 1)] = *cmd;
+    atomic_set(&cmd_head, head + 1);
+
+    return true;
+}
+
+//
+// Voices
+//
+
+static void ReleaseNote(int channel, int note) {
+    for (int i = 0; i < MUSIC_VOICES; i++) {
+        voice_t *v = &voices[i];
+        if (v->state == VOICE_ON && v->channel == channel && v->note == note) {
+            v->state = VOICE_RELEASED;
+        }
+    }
+}
+
+static void ReleaseChannel(int channel, boolean silence) {
+    for (int i = 0; i < MUSIC_VOICES; i++) {
+        voice_t *v = &voices[i];
+        if (v->state != VOICE_FREE && v->channel == channel) {
+            v->state = silence ? VOICE_FREE : VOICE_RELEASED;
+        }
+    }
+}
+
+// A free voice, or else the one that has been released the longest, or
+// else the oldest.
+static voice_t *AllocVoice(void) {
+    voice_t *best = NULL;
+
+    for (int i = 0; i < MUSIC_VOICES; i++) {
+        voice_t *v = &voices[i];
+
+        if (v->state == VOICE_FREE) {
+            return v;
+        }
+        if (best == NULL ||
+            (v->state == VOICE_RELEASED && best->state == VOICE_ON) ||
+            (v->state == best->state && v->age < best->age)) {
+            best = v;
+        }
+    }
+
+    return best;
+}
+
+static void PlayNote(int channel, int note, int velocity) {
+    mus_channel_t *ch = &mus_channels[channel];
+    const instrument_t *instrument;
+    voice_t *v;
+
+    // A note already playing is restarted
+    ReleaseNote(channel, note);
+
+    v = AllocVoice();
+    v->state = VOICE_ON;
+    v->channel = channel;
+    v->note = note;
+    v->velocity = velocity;
+    v->age = voice_age++;
+    v->env = ENV_MAX;
+    v->phase = 0;
+
+    if (channel == MUS_PERCUSSION) {
+        v->wave = waves[WAVE_NOISE];
+        v->step = NoteStep(note);
+        v->sustain = false;
+    } else {
+        instrument = &instruments_const[ch->instrument >> 3];
+        v->wave = waves[instrument->wave];
+        v->step = BentNoteStep(note, ch->bend);
+        v->sustain = instrument->sustain;
+    }
+}
+
+static void BendChannel(int channel) {
+    for (int i = 0; i < MUSIC_VOICES; i++) {
+        voice_t *v = &voices[i];
+        if (v->state != VOICE_FREE && v->channel == channel &&
+            channel != MUS_PERCUSSION) {
+            v->step = BentNoteStep(v->note, mus_channels[channel].bend);
+        }
+    }
+}
+
+// Envelopes move once per tic
+static void UpdateEnvelopes(void) {
+    for (int i = 0; i < MUSIC_VOICES; i++) {
+        voice_t *v = &voices[i];
+
+        switch (v->state) {
+        case VOICE_ON:
+            if (v->channel == MUS_PERCUSSION) {
+                v->env -= v->env >> 3;
+            } else if (v->sustain) {
+                if (v->env > ENV_SUSTAIN) {
+                    v->env -= (v->env - ENV_SUSTAIN) >> 5;
+                }
+            } else {
+                v->env -= v->env >> 6;
+            }
+            break;
+
+        case VOICE_RELEASED:
+            v->env -= v->env >> 3;
+            break;
+
+        default:
+            continue;
+        }
+
+        if (v->env < ENV_OFF) {
+            v->state = VOICE_FREE;
+        }
+    }
+}
+
+static void ResetChannels(void) {
+    for (int i = 0; i < MUS_CHANNELS; i++) {
+        mus_channels[i].instrument = 0;
+        mus_channels[i].volume = 127;
+        mus_channels[i].pan = 64;
+        mus_channels[i].velocity = 127;
+        mus_channels[i].bend = 0;
+    }
+}
+
+static void StopVoices(void) {
+    for (int i = 0; i < MUSIC_VOICES; i++) {
+        voices[i].state = VOICE_FREE;
+    }
+}
+
+//
+// Score
+//
+
+static void EndScore(void) {
+    score_playing = false;
+    atomic_set(&song_done, score_seq);
+}
+
+// Handle the next event. Returns false at the end of the score.
+static boolean ScoreEvent(void) {
+    mus_channel_t *ch;
+    int event, channel;
+    int data = 0, value = 0;
+
+    if (score >= score_end) {
+        return false;
+    }
+
+    event = *score++;
+    channel = event & 0x0F;
+    ch = &mus_channels[channel];
+
+    // Data bytes, checked once for all events
+    switch ((event >> 4) & 7) {
+    case MUS_RELEASE_NOTE:
+    case MUS_PITCH_BEND:
+    case MUS_SYSTEM_EVENT:
+        if (score >= score_end) {
+            return false;
+        }
+        data = *score++;
+        break;
+    case MUS_PLAY_NOTE:
+        if (score >= score_end) {
+            return false;
+        }
+        data = *score++;
+        value = ch->velocity;
+        if (data & 0x80) {
+            if (score >= score_end) {
+                return false;
+            }
+            value = *score++ & 0x7F;
+            ch->velocity = value;
+        }
+        break;
+    case MUS_CONTROLLER:
+        if (score + 1 >= score_end) {
+            return false;
+        }
+        data = *score++;
+        value = *score++ & 0x7F;
+        break;
+    case MUS_END_OF_MEASURE:
+        break;
+    default:
+        return false;
+    }
+
+    switch ((event >> 4) & 7) {
+    case MUS_RELEASE_NOTE:
+        ReleaseNote(channel, data & 0x7F);
+        break;
+    case MUS_PLAY_NOTE:
+        PlayNote(channel, data & 0x7F, value);
+        break;
+    case MUS_PITCH_BEND:
+        // 128 is no bend, the range is two semitones either way
+        ch->bend = data - 128;
+        BendChannel(channel);
+        break;
+    case MUS_SYSTEM_EVENT:
+        if (data == MUS_SYS_SOUNDS_OFF) {
+            ReleaseChannel(channel, true);
+        } else if (data == MUS_SYS_NOTES_OFF) {
+            ReleaseChannel(channel, false);
+        } else if (data == MUS_SYS_RESET) {
+            ch->volume = 127;
+            ch->pan = 64;
+            ch->bend = 0;
+        }
+        break;
+    case MUS_CONTROLLER:
+        if (data == MUS_CTRL_INSTRUMENT) {
+            ch->instrument = value;
+        } else if (data == MUS_CTRL_VOLUME) {
+            ch->volume = value;
+        } else if (data == MUS_CTRL_PAN) {
+            ch->pan = value;
+        }
+        break;
+    }
+
+    // The last event of a group is followed by the delay to the next
+    if (event & 0x80) {
+        score_delay = 0;
+        do {
+            if (score >= score_end) {
+                return false;
+            }
+            score_delay = (score_delay << 7) | (*score & 0x7F);
+        } while (*score++ & 0x80);
+    }
+
+    return true;
+}
+
+static void ScoreTic(void) {
+    int events = 0;
+
+    while (score_playing && score_delay == 0) {
+        if (++events > MUS_MAX_EVENTS) {
+            EndScore();
+        } else if (!ScoreEvent()) {
+            if (score_looping) {
+                score = score_start;
+            } else {
+                EndScore();
+            }
+        }
+    }
+
+    if (score_delay > 0) {
+        score_delay--;
+    }
+
+    UpdateEnvelopes();
+}
+
+static void ApplyMusicCommands(void) {
+    atomic_val_t tail = atomic_get(&cmd_tail);
+    atomic_val_t head = atomic_get(&cmd_head);
+
+    for (; tail != head; tail++) {
+        const music_cmd_t *cmd = &cmd_queue[tail & (MUSIC_CMD_QUEUE - 1)];
+
+        switch (cmd->type) {
+        case MUSIC_CMD_PLAY:
+            StopVoices();
+            ResetChannels();
+            score = score_start = cmd->score;
+            score_end = cmd->end;
+            score_looping = cmd->value;
+            score_seq = cmd->seq;
+            score_delay = 0;
+            score_playing = true;
+            score_paused = false;
+            tic_frames = 0;
+            break;
+        case MUSIC_CMD_STOP:
+            StopVoices();
+            if (score_playing) {
+                EndScore();
+            }
+            break;
+        case MUSIC_CMD_PAUSE:
+            score_paused = true;
+            break;
+        case MUSIC_CMD_RESUME:
+            score_paused = false;
+            break;
+        case MUSIC_CMD_VOLUME:
+            music_volume = cmd->value;
+            break;
+        }
+    }
+
+    atomic_set(&cmd_tail, tail);
+}
+
+//
+// Mixing
+//
+
+static void MixVoice(voice_t *v, int32_t *accum, int frames) {
+    const mus_channel_t *ch = &mus_channels[v->channel];
+    const int8_t *wave = v->wave;
+    uint32_t phase = v->phase;
+    uint32_t step = v->step;
+    int32_t gain, left, right;
+
+    // Voice, channel and music volume, and envelope, to a gain of up to
+    // 64 per side at the centre, 128 panned hard.
+    gain = ((v->velocity * ch->volume * music_volume) >> 7) * (v->env >> 7);
+    left = ((gain >> 8) * (128 - ch->pan)) >> 14;
+    right = ((gain >> 8) * ch->pan) >> 14;
+
+    for (int i = 0; i < frames; i++) {
+        int32_t sample = wave[phase >> 24];
+        accum[i * 2] += sample * left;
+        accum[i * 2 + 1] += sample * right;
+        phase += step;
+    }
+
+    v->phase = phase;
+}
+
+boolean N_I2S_MixMusic(int32_t *accum, int frames) {
+    boolean active = false;
+    int count;
+
+    ApplyMusicCommands();
+
+    if (score_paused) {
+        return false;
+    }
+
+    while (frames > 0) {
+        if (tic_frames < (1 << 16)) {
+            if (score_playing) {
+                ScoreTic();
+            } else {
+                UpdateEnvelopes();
+            }
+            tic_frames += MUS_TIC_FRAMES;
+        }
+
+        count = tic_frames >> 16;
+        if (count > frames) {
+            count = frames;
+        }
+
+        for (int i = 0; i < MUSIC_VOICES; i++) {
+            if (voices[i].state != VOICE_FREE) {
+                MixVoice(&voices[i], accum, count);
+                active = true;
+            }
+        }
+
+        accum += count * 2;
+        frames -= count;
+        tic_frames -= count << 16;
+    }
+
+    return active;
+}
+
+//
+// Music module
+//
+
+static boolean N_I2S_InitMusic(void) {
+    InitWaves();
+    ResetChannels();
+    printf("N_I2S_InitMusic: %d voices\n", MUSIC_VOICES);
+    return true;
+}
+
+static void N_I2S_SetMusicVolume(int volume) {
+    music_cmd_t cmd = {0};
+
+    cmd.type = MUSIC_CMD_VOLUME;
+    cmd.value = volume;
+    SendMusicCommand(&cmd);
+}
+
+static void N_I2S_PauseMusic(void) {
+    music_cmd_t cmd = {0};
+
+    cmd.type = MUSIC_CMD_PAUSE;
+    SendMusicCommand(&cmd);
+}
+
+static void N_I2S_ResumeMusic(void) {
+    music_cmd_t cmd = {0};
+
+    cmd.type = MUSIC_CMD_RESUME;
+    SendMusicCommand(&cmd);
+}
+
+// The song is played from the lump data, which stays in flash
+static void *N_I2S_RegisterSong(void *data, int len) {
+    const byte *mus = data;
+    song_t *song;
+    int score_len, score_start;
+
+    if (len < 16 || memcmp(mus, "MUS\x1a", 4) != 0) {
+        printf("N_I2S_RegisterSong: Not a MUS lump\n");
+        return NULL;
+    }
+
+    score_len = mus[4] | (mus[5] << 8);
+    score_start = mus[6] | (mus[7] << 8);
+    if (score_start + score_len > len) {
+        printf("N_I2S_RegisterSong: Bad MUS header\n");
+        return NULL;
+    }
+
+    song = Z_Malloc(sizeof(song_t), PU_STATIC, NULL);
+    song->score = mus + score_start;
+    song->end = mus + score_start + score_len;
+
+    return song;
+}
+
+static void N_I2S_UnRegisterSong(void *handle) {
+    if (handle != NULL) {
+        Z_Free(handle);
+    }
+}
+
+static void N_I2S_PlaySong(void *handle, boolean looping) {
+    song_t *song = handle;
+    music_cmd_t cmd = {0};
+
+    if (song == NULL) {
+        return;
+    }
+
+    cmd.type = MUSIC_CMD_PLAY;
+    cmd.value = looping;
+    cmd.seq = song_seq + 1;
+    cmd.score = song->score;
+    cmd.end = song->end;
+
+    if (SendMusicCommand(&cmd)) {
+        song_seq = cmd.seq;
+        song_playing = true;
+    }
+}
+
+static void N_I2S_StopSong(void) {
+    music_cmd_t cmd = {0};
+
+    song_playing = false;
+    cmd.type = MUSIC_CMD_STOP;
+    SendMusicCommand(&cmd);
+}
+
+static void N_I2S_ShutdownMusic(void) {
+    N_I2S_StopSong();
+}
+
+static boolean N_I2S_MusicIsPlaying(void) {
+    return song_playing && (uint8_t)atomic_get(&song_done) != song_seq;
+}
+
+static snddevice_t music_i2s_devices[] = {
+    SNDDEVICE_ADLIB, SNDDEVICE_SB, SNDDEVICE_PAS, SNDDEVICE_GUS,
+    SNDDEVICE_WAVEBLASTER, SNDDEVICE_SOUNDCANVAS, SNDDEVICE_GENMIDI,
+    SNDDEVICE_AWE32,
+};
+
+music_module_t music_i2s_module = {
+    music_i2s_devices,
+    arrlen(music_i2s_devices),
+    N_I2S_InitMusic,
+    N_I2S_ShutdownMusic,
+    N_I2S_SetMusicVolume,
+    N_I2S_PauseMusic,
+    N_I2S_ResumeMusic,
+    N_I2S_RegisterSong,
+    N_I2S_UnRegisterSong,
+    N_I2S_PlaySong,
+    N_I2S_StopSong,
+    N_I2S_MusicIsPlaying,
+    NULL,
+};
@@ -23,7 +23,16 @@
 #include <stdlib.h>
 #include <string.h>
 
+// n_i2s_sound_host.c provides the few kernel calls used here
+#ifndef N_I2S_SOUND_HOST
+#include <nrf.h>
 #include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#endif
+
+#if defined(__ARM_FEATURE_SAT)
+#include <arm_acle.h>
+#endif
 
 #include "deh_str.h"
 #include "doom_config.h"
@@ -46,39 +55,166 @@ static boolean sound_initialized = false;
 #define MIXER_STACK_SIZE 2048
 #define MIXER_PRIO 0
 
+// How often the mixer logs its CPU share and underruns, 0 to never.
+// Off unless asked for, e.g. -DMIXER_STATS_PERIOD_MS=10000.
+#ifndef MIXER_STATS_PERIOD_MS
+#define MIXER_STATS_PERIOD_MS 0
+#endif
+
 K_THREAD_STACK_DEFINE(mixer_stack, MIXER_STACK_SIZE);
 static struct k_thread mixer_thread;
 static boolean mixer_started = false;
 
-typedef struct __attribute__((packed)) mobj_s {
-    byte *ptr;
-    uint16_t pos;
-    uint16_t len;
+// Sounds are played at their own sample rate, and pitch when pitch
+// shifting is enabled, by stepping through them in 16.16 fixed point.
+// ptr and len move forward after every block, so pos stays small.
+typedef struct channel_data_s {
+    const byte *ptr;  // Next sample
+    uint32_t len;     // Samples left from ptr
+    uint32_t pos;     // 16.16 position from ptr
+    uint32_t step;    // 16.16 samples per output frame
     uint8_t left_vol;
     uint8_t right_vol;
+    boolean interpolate;
+    uint8_t seq;      // Of the command that started the sound
 } channel_data_t;
 
-channel_data_t channels[NUM_CHANNELS];
+#define MIX_FRACBITS 16
+#define MIX_FRACUNIT (1 << MIX_FRACBITS)
+
+// Interpolate linearly between samples when a sound isn't played at the
+// output rate. Build with MIX_INTERPOLATE=0 to pick the nearest sample.
+#ifndef MIX_INTERPOLATE
+#define MIX_INTERPOLATE 1
+#endif
+
+// Owned by the mixer thread. The game thread only sends commands.
+static channel_data_t channels[NUM_CHANNELS];
+
+//
+// Sound commands
+// NRFD-NOTE: The game thread queues commands in a single producer, single
+// consumer ring, and the mixer applies them before each block. Only the
+// game thread moves cmd_head and only the mixer moves cmd_tail.
+//
 
-static boolean CacheSFX(sfxinfo_t *sfxinfo, int handle) {
+typedef enum {
+    SOUND_CMD_START,
+    SOUND_CMD_STOP,
+    SOUND_CMD_PARAMS,
+} sound_cmd_type_t;
+
+typedef struct {
+    uint8_t type;
+    uint8_t channel;
+    uint8_t seq;
+    uint8_t left_vol;
+    uint8_t right_vol;
+    const byte *ptr;
+    uint32_t len;
+    uint32_t step;
+} sound_cmd_t;
+
+#define SOUND_CMD_QUEUE 32 // Power of two
+
+static sound_cmd_t cmd_queue[SOUND_CMD_QUEUE];
+static atomic_t cmd_head;
+static atomic_t cmd_tail;
+static unsigned int cmd_dropped;
+
+// A channel plays from when the game starts a sound until it stops it, or
+// the mixer has played the sound through. Sequence numbers tell the
+// mixer's end of a sound from that of an older one on the channel.
+static uint8_t channel_seq[NUM_CHANNELS];       // Game thread
+static boolean channel_active[NUM_CHANNELS];    // Game thread
+static atomic_t channel_done[NUM_CHANNELS];     // Mixer, seq of the end
+
+// Frames mixed at a time. The I2S blocks are 256 frames, larger blocks are
+// mixed in parts.
+#define MIX_FRAMES 256
+
+// Channels are added into the accumulator one after another, and packed to
+// 16 bits with saturation once all of them are in.
+static int32_t mix_accum[MIX_FRAMES * 2];
+
+#if MIXER_STATS_PERIOD_MS
+static uint32_t music_cycles;  // Mixer thread, since the last report
+
+// CPU cycles from the DWT cycle counter, started by MixerThread.
+// k_cycle_get_32() counts the 32768 Hz RTC here, too coarse for a block.
+static inline uint32_t MixerCycles(void) {
+    return DWT->CYCCNT;
+}
+#endif
+
+// Sounds resolved once, by N_I2S_PrecacheSounds or on first use, and hung
+// off sfxinfo->driver_data. Starting a sound is then a table lookup with
+// no name search or header parsing.
+typedef struct {
+    const byte *data;  // First sample, NULL for a missing or invalid sound
+    uint32_t len;      // Samples
+    uint32_t step;     // 16.16 samples per output frame at normal pitch
     int lumpnum;
+} sfx_cache_t;
+
+// Bytes of SRAM for copies of often used sounds, so the mixer doesn't read
+// them from flash. 0 to play everything from flash.
+#ifndef SFX_SRAM_BYTES
+#define SFX_SRAM_BYTES 8192
+#endif
+
+#if SFX_SRAM_BYTES
+// Copied in this order while they fit
+static const char *const sram_sounds_const[] = {
+    "pistol", "itemup", "oof", "wpnup", "noway", "swtchn", "plasma",
+    "claw", "punch", "pstop",
+};
+#endif
+
+static void GetSfxLumpName(sfxinfo_t *sfx, char *buf, size_t buf_len) {
+    // Linked sfx lumps? Get the lump number for the sound linked to.
+
+    if (sfx->link != NULL) {
+        sfx = sfx->link;
+    }
+
+    // Doom adds a DS* prefix to sound lumps; Heretic and Hexen don't
+    // do this.
+
+    if (use_sfx_prefix) {
+        M_snprintf(buf, buf_len, "ds%s", DEH_String(sfx->name));
+    } else {
+        M_StringCopy(buf, DEH_String(sfx->name), buf_len);
+    }
+}
+
+// Find the sound's lump and check its DMX header
+static void ParseSFX(sfxinfo_t *sfxinfo, sfx_cache_t *entry) {
+    char namebuf[9];
     unsigned int lumplen;
     int samplerate;
     unsigned int length;
-    byte *data;
+    const byte *data;
 
-    // need to load the sound
+    entry->data = NULL;
+    entry->len = 0;
+    entry->step = 0;
 
-    lumpnum = sfxinfo->lumpnum;
-    data = W_CacheLumpNum(lumpnum, PU_STATIC);
-    lumplen = W_LumpLength(lumpnum);
+    GetSfxLumpName(sfxinfo, namebuf, sizeof(namebuf));
+    entry->lumpnum = W_CheckNumForName(namebuf);
+    if (entry->lumpnum < 0) {
+        return;
+    }
+
+    data = W_CacheLumpNum(entry->lumpnum, PU_STATIC);
+    lumplen = W_LumpLength(entry->lumpnum);
 
     // Check the header, and ensure this is a valid sound
 
     if (lumplen < 8 || data[0] != 0x03 || data[1] != 0x00) {
         // Invalid sound
 
-        return false;
+        return;
     }
 
     // 16 bit sample rate field, 32 bit length field
@@ -95,48 +231,120 @@ static boolean CacheSFX(sfxinfo_t *sfxinfo, int handle) {
     // further investigation to better understand the correct
     // behavior.
 
-    if (length > lumplen - 8 || length <= 48) {
-        return false;
+    if (length > lumplen - 8 || length <= 48 || samplerate == 0) {
+        return;
     }
 
     // The DMX sound library seems to skip the first 16 and last 16
     // bytes of the lump - reason unknown.
+    // NRFD-NOTE: The skipped bytes at the end are what interpolation
+    // reads past the last sample.
 
-    data += 16;
-    length -= 32;
+    entry->data = data + 16;
+    entry->len = length - 32;
+    entry->step = ((uint32_t)samplerate << MIX_FRACBITS) / N_I2S_SAMPLE_RATE;
 
-    // Setup channel
-    // printf("CacheSFX: channel = %0d samplerate = %d, length = %d\n", handle,
-    // samplerate, length);
+    // W_ReleaseLumpNum(lumpnum);
+}
 
-    channels[handle].ptr = data;
-    channels[handle].pos = 0;
-    channels[handle].len = length;
+static sfx_cache_t *LookupSFX(sfxinfo_t *sfxinfo) {
+    sfx_cache_t *entry = sfxinfo->driver_data;
 
-    // W_ReleaseLumpNum(lumpnum);
+    if (entry == NULL) {
+        // Not precached
+        entry = Z_Malloc(sizeof(sfx_cache_t), PU_STATIC, NULL);
+        ParseSFX(sfxinfo, entry);
+        sfxinfo->driver_data = entry;
+    }
 
-    return true;
+    return entry;
 }
 
-static void GetSfxLumpName(sfxinfo_t *sfx, char *buf, size_t buf_len) {
-    // Linked sfx lumps? Get the lump number for the sound linked to.
+#if SFX_SRAM_BYTES
+// Move the listed sounds that fit into SRAM. The byte after the last
+// sample, read by interpolation, is copied too.
+static void CopySoundsToSRAM(sfxinfo_t *sounds, int num_sounds) {
+    int budget = SFX_SRAM_BYTES;
+    int copied = 0;
+
+    for (int i = 0; i < arrlen(sram_sounds_const); i++) {
+        for (int j = 0; j < num_sounds; j++) {
+            sfx_cache_t *entry = sounds[j].driver_data;
+            byte *copy;
+
+            if (sounds[j].link != NULL || entry == NULL ||
+                entry->data == NULL ||
+                strcmp(sounds[j].name, sram_sounds_const[i]) != 0 ||
+                (int)entry->len + 1 > budget) {
+                continue;
+            }
 
-    if (sfx->link != NULL) {
-        sfx = sfx->link;
+            copy = Z_Malloc(entry->len + 1, PU_STATIC, NULL);
+            memcpy(copy, entry->data, entry->len + 1);
+            entry->data = copy;
+            budget -= entry->len + 1;
+            copied++;
+            break;
+        }
     }
 
-    // Doom adds a DS* prefix to sound lumps; Heretic and Hexen don't
-    // do this.
+    printf("N_I2S_PrecacheSounds: %d sounds in SRAM, %d bytes\n", copied,
+           SFX_SRAM_BYTES - budget);
+}
+#endif
 
-    if (use_sfx_prefix) {
-        M_snprintf(buf, buf_len, "ds%s", DEH_String(sfx->name));
-    } else {
-        M_StringCopy(buf, DEH_String(sfx->name), buf_len);
+static boolean CacheSFX(sfxinfo_t *sfxinfo, sound_cmd_t *cmd, int pitch) {
+    const sfx_cache_t *entry = LookupSFX(sfxinfo);
+    uint32_t step;
+
+    if (entry->data == NULL) {
+        return false;
+    }
+
+    step = entry->step;
+    if (snd_pitchshift) {
+        step = step * pitch / NORM_PITCH;
     }
+    if (step == 0) {
+        step = 1;
+    }
+
+    cmd->ptr = entry->data;
+    cmd->len = entry->len;
+    cmd->step = step;
+
+    return true;
 }
 
+// Resolve every sound into one table. Linked sounds share the entry of
+// the sound they link to.
 static void N_I2S_PrecacheSounds(sfxinfo_t *sounds, int num_sounds) {
-    printf("NRFD-TODO: N_I2S_PrecacheSounds?\n");
+    sfx_cache_t *table;
+    int i;
+
+    table = Z_Malloc(num_sounds * sizeof(sfx_cache_t), PU_STATIC, NULL);
+
+    for (i = 0; i < num_sounds; i++) {
+        if (sounds[i].link == NULL) {
+            ParseSFX(&sounds[i], &table[i]);
+            sounds[i].driver_data = &table[i];
+        }
+    }
+
+    for (i = 0; i < num_sounds; i++) {
+        if (sounds[i].link != NULL) {
+            if (sounds[i].link->driver_data == NULL) {
+                ParseSFX(&sounds[i], &table[i]);
+                sounds[i].driver_data = &table[i];
+            } else {
+                sounds[i].driver_data = sounds[i].link->driver_data;
+            }
+        }
+    }
+
+#if SFX_SRAM_BYTES
+    CopySoundsToSRAM(sounds, num_sounds);
+#endif
 }
 
 //
@@ -146,19 +354,36 @@ static void N_I2S_PrecacheSounds(sfxinfo_t *sounds, int num_sounds) {
 
 static int N_I2S_GetSfxLumpNum(sfxinfo_t *sfx) {
     char namebuf[9];
+    int lumpnum = LookupSFX(sfx)->lumpnum;
+
+    if (lumpnum >= 0) {
+        return lumpnum;
+    }
 
+    // Missing, error out as before
     GetSfxLumpName(sfx, namebuf, sizeof(namebuf));
 
     return W_GetNumForName(namebuf);
 }
 
-static void N_I2S_UpdateSoundParams(int handle, int vol, int sep) {
-    int left, right;
+// Queue a command for the mixer. Returns false when the queue is full.
+static boolean SendSoundCommand(const sound_cmd_t *cmd) {
+    atomic_val_t head = atomic_get(&cmd_head);
 
-    if (!sound_initialized || handle < 0 || handle >= NUM_CHANNELS) {
-        return;
+    if ((uint32_t)head - (uint32_t)atomic_get(&cmd_tail) >= SOUND_CMD_QUEUE) {
+        cmd_dropped++;
+        return false;
     }
 
+    cmd_queue[head & (SOUND_CMD_QUEUE - 1)] = *cmd;
+    atomic_set(&cmd_head, head + 1);
+
+    return true;
+}
+
+static void SetSoundParams(sound_cmd_t *cmd, int vol, int sep) {
+    int left, right;
+
     left = ((254 - sep) * vol) / 127;
     right = ((sep)*vol) / 127;
 
@@ -171,18 +396,53 @@ static void N_I2S_UpdateSoundParams(int handle, int vol, int sep) {
     else if (right > 255)
         right = 255;
 
-    channels[handle].left_vol = left;
-    channels[handle].right_vol = right;
+    cmd->left_vol = left;
+    cmd->right_vol = right;
+}
+
+static void N_I2S_UpdateSoundParams(int handle, int vol, int sep) {
+    sound_cmd_t cmd = {0};
+
+    if (!sound_initialized || handle < 0 || handle >= NUM_CHANNELS) {
+        return;
+    }
+
+    cmd.type = SOUND_CMD_PARAMS;
+    cmd.channel = handle;
+    SetSoundParams(&cmd, vol, sep);
+    SendSoundCommand(&cmd);
 }
 
 static void ClearSoundOnChannel(int channel) {
     channels[channel].ptr = NULL;
     channels[channel].len = 0;
     channels[channel].pos = 0;
+    channels[channel].step = MIX_FRACUNIT;
+    channels[channel].interpolate = false;
     channels[channel].left_vol = 0;
     channels[channel].right_vol = 0;
 }
 
+// Mixer end of a sound, played through or stopped
+static void EndSoundOnChannel(int channel) {
+    atomic_set(&channel_done[channel], channels[channel].seq);
+    ClearSoundOnChannel(channel);
+}
+
+static void N_I2S_StopSound(int handle) {
+    sound_cmd_t cmd = {0};
+
+    if (!sound_initialized || handle < 0 || handle >= NUM_CHANNELS) {
+        return;
+    }
+
+    channel_active[handle] = false;
+
+    cmd.type = SOUND_CMD_STOP;
+    cmd.channel = handle;
+    SendSoundCommand(&cmd);
+}
+
 //
 // Starting a sound means adding it
 //  to the current list of active sounds
@@ -193,116 +453,306 @@ static void ClearSoundOnChannel(int channel) {
 // As our sound handling does not handle
 //  priority, it is ignored.
 // Pitching (that is, increased speed of playback)
-//  is set, but currently not used by mixing.
+//  is used when snd_pitchshift is set.
 //
 
 static int N_I2S_StartSound(sfxinfo_t *sfxinfo, int channel, int vol, int sep,
                             int pitch) {
+    sound_cmd_t cmd = {0};
+
     if (!sound_initialized || channel < 0 || channel >= NUM_CHANNELS) {
         return -1;
     }
 
-    // Clear a sound effect if there is already one playing
-    // on this channel
-
-    ClearSoundOnChannel(channel);
-
-    // Get the sound data
+    // Get the sound data. A sound already playing on this channel is
+    // replaced by the mixer.
 
-    if (!CacheSFX(sfxinfo, channel)) {
+    if (!CacheSFX(sfxinfo, &cmd, pitch)) {
         printf("N_I2S_StartSound: Error caching SFX\n");
-        return false;
+        N_I2S_StopSound(channel);
+        return -1;
     }
 
     // set separation, etc.
 
-    N_I2S_UpdateSoundParams(channel, vol, sep);
+    cmd.type = SOUND_CMD_START;
+    cmd.channel = channel;
+    cmd.seq = channel_seq[channel] + 1;
+    SetSoundParams(&cmd, vol, sep);
+
+    if (!SendSoundCommand(&cmd)) {
+        return -1;
+    }
+
+    channel_seq[channel] = cmd.seq;
+    channel_active[channel] = true;
 
     return channel;
 }
 
-static void N_I2S_StopSound(int handle) {
+static boolean N_I2S_SoundIsPlaying(int handle) {
     if (!sound_initialized || handle < 0 || handle >= NUM_CHANNELS) {
-        return;
+        return false;
     }
 
-    ClearSoundOnChannel(handle);
+    return channel_active[handle] &&
+           (uint8_t)atomic_get(&channel_done[handle]) != channel_seq[handle];
 }
 
-static boolean N_I2S_SoundIsPlaying(int handle) {
-    if (!sound_initialized || handle < 0 || handle >= NUM_CHANNELS) {
-        return false;
+// Apply the commands queued by the game thread, in the mixer thread
+static void ApplySoundCommands(void) {
+    atomic_val_t tail = atomic_get(&cmd_tail);
+    atomic_val_t head = atomic_get(&cmd_head);
+
+    for (; tail != head; tail++) {
+        const sound_cmd_t *cmd = &cmd_queue[tail & (SOUND_CMD_QUEUE - 1)];
+        channel_data_t *ch = &channels[cmd->channel];
+
+        switch (cmd->type) {
+        case SOUND_CMD_START:
+            ch->ptr = cmd->ptr;
+            ch->len = cmd->len;
+            ch->pos = 0;
+            ch->step = cmd->step;
+            ch->interpolate = MIX_INTERPOLATE && cmd->step != MIX_FRACUNIT;
+            ch->left_vol = cmd->left_vol;
+            ch->right_vol = cmd->right_vol;
+            ch->seq = cmd->seq;
+            break;
+
+        case SOUND_CMD_STOP:
+            if (ch->ptr != NULL) {
+                EndSoundOnChannel(cmd->channel);
+            }
+            break;
+
+        case SOUND_CMD_PARAMS:
+            ch->left_vol = cmd->left_vol;
+            ch->right_vol = cmd->right_vol;
+            break;
+        }
     }
 
-    return (channels[handle].ptr != NULL);
+    atomic_set(&cmd_tail, tail);
 }
 
 //
-// Periodically called to update the sound system
+// Mixing
 //
 
-static void N_I2S_UpdateSound(void) {
-    // printf("N_I2S_UpdateSound\n");
-    if (!mixer_started) {
-        int16_t *buf;
-        int buf_len;
-        while (N_I2S_next_buffer(&buf_len, &buf)) {
-            for (int i = 0; i < buf_len / 2; i++) {
-                int16_t sample_l = 0;
-                int16_t sample_r = 0;
-                for (int j = 0; j < NUM_CHANNELS; j++) {
-                    channel_data_t ch = channels[j];
-                    if (ch.ptr != NULL) {
-                        int16_t sample = ch.ptr[ch.pos] - 128;
-                        channels[j].pos++;
-                        if (channels[j].pos >= ch.len) {
-                            ClearSoundOnChannel(j);
-                        }
-                        sample_l += sample * ch.left_vol;
-                        sample_r += sample * ch.right_vol;
-                    }
-                }
-                buf[i * 2] = sample_l;
-                buf[i * 2 + 1] = sample_r;
+static inline int16_t MixSaturate(int32_t sample) {
+#if defined(__ARM_FEATURE_SAT)
+    return __ssat(sample, 16);
+#else
+    if (sample > INT16_MAX) {
+        return INT16_MAX;
+    } else if (sample < INT16_MIN) {
+        return INT16_MIN;
+    }
+    return sample;
+#endif
+}
+
+// Add the next frames of a channel to the accumulator. Returns false when
+// the channel has nothing to add.
+static boolean MixChannel(int channel, int32_t *accum, int frames) {
+    channel_data_t *ch = &channels[channel];
+    const byte *src;
+    int32_t left_vol, right_vol;
+    uint32_t pos, step, last;
+    int count;
+    int i;
+
+    if (ch->ptr == NULL) {
+        return false;
+    }
+
+    src = ch->ptr;
+    pos = ch->pos;
+    step = ch->step;
+    left_vol = ch->left_vol;
+    right_vol = ch->right_vol;
+
+    if (step == MIX_FRACUNIT) {
+        // Played at the output rate
+        count = ch->len < (uint32_t)frames ? ch->len : frames;
+
+        for (i = 0; i < count; i++) {
+            int32_t sample = src[i] - 128;
+            accum[i * 2] += sample * left_vol;
+            accum[i * 2 + 1] += sample * right_vol;
+        }
+
+        pos = count << MIX_FRACBITS;
+    } else {
+        // Frames until the end of the sound, when it is in this block
+        count = frames;
+        last = (pos + (frames - 1) * step) >> MIX_FRACBITS;
+        if (last >= ch->len) {
+            count = ((ch->len << MIX_FRACBITS) - pos + step - 1) / step;
+        }
+
+        if (ch->interpolate) {
+            for (i = 0; i < count; i++) {
+                const byte *s = src + (pos >> MIX_FRACBITS);
+                int32_t frac = (pos >> (MIX_FRACBITS - 8)) & 0xff;
+                int32_t sample = s[0] - 128;
+
+                sample += ((s[1] - s[0]) * frac) >> 8;
+                accum[i * 2] += sample * left_vol;
+                accum[i * 2 + 1] += sample * right_vol;
+                pos += step;
+            }
+        } else {
+            for (i = 0; i < count; i++) {
+                int32_t sample = src[pos >> MIX_FRACBITS] - 128;
+                accum[i * 2] += sample * left_vol;
+                accum[i * 2 + 1] += sample * right_vol;
+                pos += step;
             }
         }
-        N_I2S_process();
     }
+
+    if ((pos >> MIX_FRACBITS) >= ch->len) {
+        EndSoundOnChannel(channel);
+    } else {
+        ch->ptr += pos >> MIX_FRACBITS;
+        ch->len -= pos >> MIX_FRACBITS;
+        ch->pos = pos & (MIX_FRACUNIT - 1);
+    }
+
+    return true;
 }
 
-static void N_I2S_ShutdownSound(void) {}
+// Mix frames of stereo samples into buf
+static void MixBlock(int16_t *buf, int frames) {
+    ApplySoundCommands();
+
+    while (frames > 0) {
+        int count = frames < MIX_FRAMES ? frames : MIX_FRAMES;
+        boolean active = false;
+
+        memset(mix_accum, 0, count * 2 * sizeof(*mix_accum));
+
+        for (int j = 0; j < NUM_CHANNELS; j++) {
+            if (MixChannel(j, mix_accum, count)) {
+                active = true;
+            }
+        }
+
+#if MIXER_STATS_PERIOD_MS
+        uint32_t music_start = MixerCycles();
+#endif
+        if (N_I2S_MixMusic(mix_accum, count)) {
+            active = true;
+        }
+#if MIXER_STATS_PERIOD_MS
+        music_cycles += MixerCycles() - music_start;
+#endif
+
+        if (active) {
+            for (int i = 0; i < count * 2; i++) {
+                buf[i] = MixSaturate(mix_accum[i]);
+            }
+        } else {
+            // Nothing playing
+            memset(buf, 0, count * 2 * sizeof(*buf));
+        }
+
+        buf += count * 2;
+        frames -= count;
+    }
+}
 
 static bool MixSoundOnce(void) {
     bool did_work = false;
     int16_t *buf;
     int buf_len;
 
-    while (N_I2S_next_buffer(&buf_len, &buf)) {
+    while (N_I2S_next_buffer(&buf_len, &buf, false)) {
         did_work = true;
-        for (int i = 0; i < buf_len / 2; i++) {
-            int16_t sample_l = 0;
-            int16_t sample_r = 0;
-            for (int j = 0; j < NUM_CHANNELS; j++) {
-                channel_data_t ch = channels[j];
-                if (ch.ptr != NULL) {
-                    int16_t sample = ch.ptr[ch.pos] - 128;
-                    channels[j].pos++;
-                    if (channels[j].pos >= ch.len) {
-                        ClearSoundOnChannel(j);
-                    }
-                    sample_l += sample * ch.left_vol;
-                    sample_r += sample * ch.right_vol;
-                }
-            }
-            buf[i * 2] = sample_l;
-            buf[i * 2 + 1] = sample_r;
-        }
+        MixBlock(buf, buf_len / 2);
+        N_I2S_submit_buffer();
     }
 
     return did_work;
 }
 
+//
+// Periodically called to update the sound system
+//
+
+static void N_I2S_UpdateSound(void) {
+    // printf("N_I2S_UpdateSound\n");
+    if (!mixer_started) {
+        MixSoundOnce();
+        N_I2S_process();
+    }
+}
+
+static void N_I2S_ShutdownSound(void) {}
+
+#if MIXER_STATS_PERIOD_MS
+// Log the share of the CPU spent mixing, and how much of it went to the
+// music synthesizer, per block, to help choose MUSIC_VOICES. Also the
+// blocks the I2S feeder had to fill with silence.
+// The counter wraps every 2^32 cycles, about 33 s at 128 MHz, so the
+// elapsed cycles are added up a block at a time.
+static void MixerStats(uint32_t mix_cycles) {
+    static uint32_t last_cycles;
+    static uint64_t elapsed_cycles;
+    static uint64_t busy_cycles;
+    static uint32_t blocks;
+    static int64_t next_report;
+    uint32_t cycles = MixerCycles();
+    n_i2s_stats_t stats;
+    int permille;
+
+    elapsed_cycles += cycles - last_cycles;
+    last_cycles = cycles;
+    busy_cycles += mix_cycles;
+    blocks++;
+
+    if (next_report == 0) {
+        elapsed_cycles = 0;
+        busy_cycles = 0;
+        blocks = 0;
+        music_cycles = 0;
+        next_report = k_uptime_get() + MIXER_STATS_PERIOD_MS;
+        return;
+    }
+
+    if (k_uptime_get() < next_report) {
+        return;
+    }
+
+    permille = busy_cycles * 1000 / elapsed_cycles;
+    N_I2S_get_stats(&stats);
+    printf("Mixer: %d.%d%% CPU, %u cycles/block (music %u), %u underruns, "
+           "%u recoveries, %u commands dropped\n",
+           permille / 10, permille % 10, (unsigned)(busy_cycles / blocks),
+           (unsigned)(music_cycles / blocks), (unsigned)stats.underruns,
+           (unsigned)stats.recoveries, cmd_dropped);
+
+    elapsed_cycles = 0;
+    busy_cycles = 0;
+    blocks = 0;
+    music_cycles = 0;
+    next_report += MIXER_STATS_PERIOD_MS;
+}
+#endif
+
+// Mix a block whenever the I2S feeder frees one
 static void MixerThread(void *a, void *b, void *c) {
+    int16_t *buf;
+    int buf_len;
+#if MIXER_STATS_PERIOD_MS
+    uint32_t start;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
     ARG_UNUSED(a);
     ARG_UNUSED(b);
     ARG_UNUSED(c);
@@ -313,14 +763,21 @@ static void MixerThread(void *a, void *b, void *c) {
             continue;
         }
 
-        bool did_work = MixSoundOnce();
         N_I2S_process();
 
-        if (!did_work) {
-            k_sleep(K_MSEC(1));
-        } else {
-            k_yield();
+        if (!N_I2S_next_buffer(&buf_len, &buf, true)) {
+            continue;
         }
+
+#if MIXER_STATS_PERIOD_MS
+        start = MixerCycles();
+#endif
+        MixBlock(buf, buf_len / 2);
+        N_I2S_submit_buffer();
+
+#if MIXER_STATS_PERIOD_MS
+        MixerStats(MixerCycles() - start);
+#endif
     }
 }
 
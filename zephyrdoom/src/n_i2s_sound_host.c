@@ -0,0 +1,219 @@
+//
+// Copyright(C) 2021 Nordic Semiconductor ASA
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Host benchmark of the sound effect mixer, not part of the
+//      firmware. Mixes 256 frame blocks with 1, 4, 8 and 16 voices
+//      through MixBlock, and through the frame at a time loop it
+//      replaced, and prints the time per block. Nothing clips, so both
+//      must give the same samples, which is checked.
+//
+//      Build and run from this directory:
+//
+//          cc -O2 -I. -Iconfig n_i2s_sound_host.c
+//          ./a.out
+//
+//      The relative numbers are what matter. For target numbers, build
+//      the same file with the board's compiler flags and run it there.
+//
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// The kernel calls n_i2s_sound.c makes, none of which are timed
+#define N_I2S_SOUND_HOST 1
+#define MIXER_STATS_PERIOD_MS 0
+
+typedef long atomic_t;
+typedef long atomic_val_t;
+struct k_thread { int unused; };
+
+#define atomic_get(target) (*(target))
+#define atomic_set(target, value) (*(target) = (value))
+#define ARG_UNUSED(x) (void)(x)
+#define K_MSEC(ms) (ms)
+#define K_NO_WAIT 0
+#define K_THREAD_STACK_DEFINE(sym, size) static char sym[size]
+#define K_THREAD_STACK_SIZEOF(sym) sizeof(sym)
+
+static void k_sleep(int ms) {}
+static void k_thread_create(struct k_thread *thread, char *stack, size_t size,
+                            void (*entry)(void *, void *, void *), void *a,
+                            void *b, void *c, int prio, int options,
+                            int delay) {}
+
+#include "n_i2s_sound.c"
+
+#define HOST_BLOCKS 2000
+#define HOST_RUNS   10
+#define HOST_FRAMES 256
+
+// Long enough that no voice ends during a run
+#define HOST_SOUND_LEN (HOST_FRAMES * HOST_BLOCKS)
+
+// Stand-ins for what n_i2s_sound.c uses from the rest of the game
+int snd_pitchshift;
+
+char *DEH_String(char *s) { return s; }
+boolean M_StringCopy(char *dest, const char *src, size_t dest_size) {
+    strncpy(dest, src, dest_size);
+    return true;
+}
+int M_snprintf(char *buf, size_t buf_len, const char *s, ...) {
+    va_list args;
+    int result;
+
+    va_start(args, s);
+    result = vsnprintf(buf, buf_len, s, args);
+    va_end(args);
+    return result;
+}
+lumpindex_t W_CheckNumForName(const char *name) { return -1; }
+lumpindex_t W_GetNumForName(const char *name) { return -1; }
+int W_LumpLength(lumpindex_t lump) { return 0; }
+void *W_CacheLumpNum(lumpindex_t lump, int tag) { return NULL; }
+void W_ReleaseLumpNum(lumpindex_t lump) {}
+void *Z_Malloc(int size, int tag, void *user) { return malloc(size); }
+boolean N_I2S_MixMusic(int32_t *accum, int frames) { return false; }
+boolean N_I2S_next_buffer(int *buf_size, int16_t **buffer, boolean wait) {
+    return false;
+}
+void N_I2S_submit_buffer(void) {}
+void N_I2S_process() {}
+void N_I2S_get_stats(n_i2s_stats_t *stats) {}
+
+static byte sound[HOST_SOUND_LEN];
+static int16_t block[HOST_FRAMES * 2];
+static int16_t reference[HOST_FRAMES * 2];
+
+//
+// The loop MixBlock replaced: every frame visits every channel, and the
+// sum is kept in 16 bits.
+//
+
+typedef struct {
+    const byte *ptr;
+    uint32_t pos;
+    uint32_t len;
+    uint8_t left_vol;
+    uint8_t right_vol;
+} base_channel_t;
+
+static base_channel_t base_channels[NUM_CHANNELS];
+
+static void BaseMixBlock(int16_t *buf, int frames) {
+    for (int i = 0; i < frames; i++) {
+        int16_t sample_l = 0;
+        int16_t sample_r = 0;
+        for (int j = 0; j < NUM_CHANNELS; j++) {
+            base_channel_t ch = base_channels[j];
+            if (ch.ptr != NULL) {
+                int16_t sample = ch.ptr[ch.pos] - 128;
+                base_channels[j].pos++;
+                if (base_channels[j].pos >= ch.len) {
+                    base_channels[j].ptr = NULL;
+                }
+                sample_l += sample * ch.left_vol;
+                sample_r += sample * ch.right_vol;
+            }
+        }
+        buf[i * 2] = sample_l;
+        buf[i * 2 + 1] = sample_r;
+    }
+}
+
+// Start the same voices on both mixers, at the output rate as the old
+// loop had no pitch. Volumes are low enough that 16 voices don't clip,
+// so both mixers add up to the same samples.
+static void StartVoices(int voices) {
+    for (int j = 0; j < NUM_CHANNELS; j++) {
+        ClearSoundOnChannel(j);
+        memset(&base_channels[j], 0, sizeof(base_channels[j]));
+    }
+
+    for (int j = 0; j < voices; j++) {
+        channels[j].ptr = sound + j;
+        channels[j].len = HOST_SOUND_LEN - j;
+        channels[j].step = MIX_FRACUNIT;
+        channels[j].left_vol = 4 + j % 8;
+        channels[j].right_vol = 12 - j % 8;
+
+        base_channels[j].ptr = sound + j;
+        base_channels[j].len = HOST_SOUND_LEN - j;
+        base_channels[j].left_vol = 4 + j % 8;
+        base_channels[j].right_vol = 12 - j % 8;
+    }
+}
+
+static double NowUS(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+// Best of HOST_RUNS, in us per block
+static double TimeBlocks(int voices, boolean base) {
+    double best = 0;
+    double start, time;
+
+    for (int run = 0; run < HOST_RUNS; run++) {
+        StartVoices(voices);
+
+        start = NowUS();
+        for (int n = 0; n < HOST_BLOCKS; n++) {
+            if (base) {
+                BaseMixBlock(block, HOST_FRAMES);
+            } else {
+                MixBlock(block, HOST_FRAMES);
+            }
+        }
+        time = (NowUS() - start) / HOST_BLOCKS;
+
+        if (run == 0 || time < best) {
+            best = time;
+        }
+    }
+
+    return best;
+}
+
+static boolean SameSamples(int voices) {
+    StartVoices(voices);
+    BaseMixBlock(reference, HOST_FRAMES);
+    MixBlock(block, HOST_FRAMES);
+
+    return memcmp(reference, block, sizeof(block)) == 0;
+}
+
+int main(void) {
+    static const int voices[] = {1, 4, 8, 16};
+
+    for (int i = 0; i < HOST_SOUND_LEN; i++) {
+        sound[i] = rand();
+    }
+
+    printf("voices  us/block  baseline us/block\n");
+    for (unsigned int i = 0; i < sizeof(voices) / sizeof(voices[0]); i++) {
+        printf("%6d  %8.2f  %17.2f%s\n", voices[i],
+               TimeBlocks(voices[i], false), TimeBlocks(voices[i], true),
+               SameSamples(voices[i]) ? "" : "  SAMPLES DIFFER");
+    }
+
+    return 0;
+}
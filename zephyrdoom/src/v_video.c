@@ -59,7 +59,7 @@ byte *xlatab = NULL;
 
 static pixel_t *dest_screen = NULL;
 
-// NRFD-EXCLUDE //int dirtybox[4];
+int dirtybox[4];
 
 // haleyjd 08/28/10: clipping callback function for patches.
 // This is needed for Chocolate Strife, which clips patches to the screen.
@@ -70,15 +70,20 @@ static vpatchclipfunc_t patchclip_callback = NULL;
 //
 void V_MarkRect(int x, int y, int width, int height)
 {
+    // NRFD-NOTE: Drawing into the status bar layer flags it for upload.
+    if (dest_screen == I_StatusBarScreen)
+    {
+        I_MarkStatusBarDirty();
+    }
+
     // If we are temporarily using an alternate screen, do not
     // affect the update box.
-    /* NRFD-EXCLUDE:
+    // NRFD-NOTE: Used to send only the rows drawn over a scaled view.
     if (dest_screen == I_VideoBuffer)
     {
         M_AddToBox (dirtybox, x, y);
         M_AddToBox (dirtybox, x + width-1, y + height-1);
     }
-    */
 }
 
 